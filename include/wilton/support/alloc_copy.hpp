@@ -23,12 +23,16 @@ sl::io::span<char> alloc_copy_span(Buffer buf) {
     return sink.release();
 }
 
+// used for error messages, that are not allocated
+// from arenas because they can outlive them
 inline char* alloc_copy(const std::string& str) STATICLIB_NOEXCEPT {
     try {
-        return alloc_copy_span(str).data();
+        auto sink = sl::io::make_array_sink(wilton_alloc_detached, wilton_free, str.size());
+        sink.write(str);
+        return sink.release().data();
     } catch(...) {
         // bad alloc
-        char* err = static_cast<char*> (wilton_alloc(2));
+        char* err = static_cast<char*> (wilton_alloc_detached(2));
         err[0] = 'E';
         err[1] = '\0';
         return err;
@@ -8,6 +8,11 @@
 #ifndef WILTON_SUPPORT_SPAN_OPERATIONS_HPP
 #define WILTON_SUPPORT_SPAN_OPERATIONS_HPP
 
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+
 #include "staticlib/io.hpp"
 #include "staticlib/json.hpp"
 #include "staticlib/support.hpp"
@@ -15,12 +20,235 @@
 #include "wilton/wilton.h"
 
 #include "wilton/support/alloc_copy.hpp"
+#include "wilton/support/exception.hpp"
 
 namespace wilton {
 namespace support {
 
 using buffer = sl::support::optional<sl::io::span<char>>;
 
+namespace detail_buffer {
+
+// caller buffer of a call registered with 'register_wiltoncall_into'
+struct into_target {
+    char* buf;
+    size_t cap;
+    size_t len = 0;
+    bool used = false;
+
+    into_target(char* buf, size_t cap) :
+    buf(buf),
+    cap(cap) { }
+};
+
+inline into_target*& current_into_target() {
+    thread_local into_target* target = nullptr;
+    return target;
+}
+
+// target is used only by the first result helper called in the call
+inline into_target* take_into_target() {
+    auto& current = current_into_target();
+    auto res = current;
+    if (nullptr != res) {
+        res->used = true;
+        current = nullptr;
+    }
+    return res;
+}
+
+// writes what fits and counts the full length
+class into_sink {
+    into_target& target;
+
+public:
+    into_sink(into_target& target) :
+    target(target) { }
+
+    std::streamsize write(sl::io::span<const char> span) {
+        if (target.len < target.cap) {
+            auto avail = target.cap - target.len;
+            auto count = span.size() < avail ? span.size() : avail;
+            std::memcpy(target.buf + target.len, span.data(), count);
+        }
+        target.len += span.size();
+        return static_cast<std::streamsize> (span.size());
+    }
+
+    std::streamsize flush() {
+        return 0;
+    }
+};
+
+inline buffer make_into_buffer(into_target& target) {
+    return sl::support::make_optional(sl::io::make_span(target.buf, target.len));
+}
+
+// scratch buffers larger than this are released after use
+const size_t scratch_max_retained_size = 1 << 24;
+
+struct scratch_state {
+    std::string data;
+    bool in_use = false;
+};
+
+inline scratch_state& thread_scratch() {
+    thread_local scratch_state state;
+    return state;
+}
+
+/**
+ * Per-thread serialization buffer, output is collected there
+ * and then copied into a single allocation of the exact size,
+ * empty for nested use on the same thread
+ */
+class scratch_lease {
+    scratch_state* state = nullptr;
+
+public:
+    scratch_lease() {
+        auto& st = thread_scratch();
+        if (!st.in_use) {
+            st.in_use = true;
+            state = std::addressof(st);
+        }
+    }
+
+    scratch_lease(const scratch_lease&) = delete;
+
+    scratch_lease& operator=(const scratch_lease&) = delete;
+
+    ~scratch_lease() STATICLIB_NOEXCEPT {
+        if (nullptr != state) {
+            if (state->data.capacity() > scratch_max_retained_size) {
+                std::string().swap(state->data);
+            } else {
+                state->data.clear();
+            }
+            state->in_use = false;
+        }
+    }
+
+    std::string* get() {
+        return nullptr != state ? std::addressof(state->data) : nullptr;
+    }
+};
+
+/**
+ * Growable 'wilton_alloc' buffer, grows with 'wilton_realloc'
+ * so large buffers are resized without copying
+ */
+class realloc_sink {
+    char* buf = nullptr;
+    size_t len = 0;
+    size_t cap = 0;
+
+public:
+    realloc_sink() { }
+
+    realloc_sink(const realloc_sink&) = delete;
+
+    realloc_sink& operator=(const realloc_sink&) = delete;
+
+    ~realloc_sink() STATICLIB_NOEXCEPT {
+        wilton_free(buf);
+    }
+
+    std::streamsize write(sl::io::span<const char> span) {
+        reserve(len + span.size());
+        std::memcpy(buf + len, span.data(), span.size());
+        len += span.size();
+        return static_cast<std::streamsize> (span.size());
+    }
+
+    std::streamsize flush() {
+        return 0;
+    }
+
+    // trims the buffer to the written size
+    sl::io::span<char> release() {
+        reserve(1);
+        if (len > 0 && len < cap) {
+            auto trimmed = wilton_realloc(buf, static_cast<int> (len));
+            if (nullptr != trimmed) {
+                buf = trimmed;
+            }
+        }
+        auto res = sl::io::make_span(buf, len);
+        buf = nullptr;
+        len = 0;
+        cap = 0;
+        return res;
+    }
+
+private:
+    void reserve(size_t needed) {
+        if (needed <= cap) {
+            return;
+        }
+        auto next_cap = cap > 0 ? cap * 2 : static_cast<size_t> (4096);
+        if (next_cap < needed) {
+            next_cap = needed;
+        }
+        if (next_cap > static_cast<size_t> (std::numeric_limits<int>::max())) {
+            next_cap = static_cast<size_t> (std::numeric_limits<int>::max());
+            if (next_cap < needed) {
+                throw exception(TRACEMSG("Buffer size limit exceeded, required: [" +
+                        sl::support::to_string(needed) + "]"));
+            }
+        }
+        auto next = wilton_realloc(buf, static_cast<int> (next_cap));
+        if (nullptr == next) {
+            throw exception(TRACEMSG("Buffer allocation error, size: [" +
+                    sl::support::to_string(next_cap) + "]"));
+        }
+        buf = next;
+        cap = next_cap;
+    }
+};
+
+// output larger than the retained scratch size is moved to a growable buffer
+class scratch_sink {
+    std::string& data;
+    realloc_sink spill;
+    bool spilled = false;
+
+public:
+    scratch_sink(std::string& data) :
+    data(data) { }
+
+    scratch_sink(const scratch_sink&) = delete;
+
+    scratch_sink& operator=(const scratch_sink&) = delete;
+
+    std::streamsize write(sl::io::span<const char> span) {
+        if (!spilled) {
+            if (data.length() + span.size() <= scratch_max_retained_size) {
+                data.append(span.data(), span.size());
+                return static_cast<std::streamsize> (span.size());
+            }
+            spill.write(sl::io::make_span(data.data(), data.length()));
+            data.clear();
+            spilled = true;
+        }
+        return spill.write(span);
+    }
+
+    std::streamsize flush() {
+        return 0;
+    }
+
+    buffer release() {
+        if (spilled) {
+            return sl::support::make_optional(spill.release());
+        }
+        auto span = alloc_copy_span(sl::io::make_span(data.data(), data.length()));
+        return sl::support::make_optional(std::move(span));
+    }
+};
+
+} // namespace
+
 inline buffer make_empty_buffer() {
     return sl::support::optional<sl::io::span<char>>();
 }
@@ -41,25 +269,70 @@ inline buffer make_string_buffer(const std::string& st) {
 }
 
 inline buffer make_json_buffer(const sl::json::value& val) {
-    auto sink = sl::io::make_array_sink(wilton_alloc, wilton_free);
+    detail_buffer::scratch_lease lease;
+    if (nullptr != lease.get()) {
+        detail_buffer::scratch_sink sink{*lease.get()};
+        val.dump(sink);
+        return sink.release();
+    }
+    detail_buffer::realloc_sink sink;
     val.dump(sink);
     return sl::support::make_optional(sink.release());
 }
 
 template<typename Source>
 buffer make_source_buffer(Source& src) {
-    auto sink = sl::io::make_array_sink(wilton_alloc, wilton_free);
+    detail_buffer::scratch_lease lease;
+    if (nullptr != lease.get()) {
+        detail_buffer::scratch_sink sink{*lease.get()};
+        sl::io::copy_all(src, sink);
+        return sink.release();
+    }
+    detail_buffer::realloc_sink sink;
     sl::io::copy_all(src, sink);
     return sl::support::make_optional(sink.release());
 }
 
 template<typename Source>
 buffer make_hex_buffer(Source& src) {
-    auto sink = sl::io::make_array_sink(wilton_alloc, wilton_free);
+    detail_buffer::scratch_lease lease;
+    if (nullptr != lease.get()) {
+        detail_buffer::scratch_sink sink{*lease.get()};
+        sl::io::copy_to_hex(src, sink);
+        return sink.release();
+    }
+    detail_buffer::realloc_sink sink;
     sl::io::copy_to_hex(src, sink);
     return sl::support::make_optional(sink.release());
 }
 
+/**
+ * Result of a function registered with 'register_wiltoncall_into', written
+ * directly to the caller buffer of 'wiltoncall_into' and allocated as with
+ * 'make_json_buffer' otherwise; must be returned by the function as is,
+ * 'make_*_buffer' helpers always allocate and can be used for intermediate data
+ */
+inline buffer make_json_result(const sl::json::value& val) {
+    auto target = detail_buffer::take_into_target();
+    if (nullptr != target) {
+        auto sink = detail_buffer::into_sink(*target);
+        val.dump(sink);
+        return detail_buffer::make_into_buffer(*target);
+    }
+    return make_json_buffer(val);
+}
+
+// same as 'make_json_result' for already serialized data
+inline buffer make_string_result(const std::string& st) {
+    auto target = detail_buffer::take_into_target();
+    if (nullptr != target) {
+        auto sink = detail_buffer::into_sink(*target);
+        sink.write(sl::io::make_span(st.data(), st.length()));
+        return detail_buffer::make_into_buffer(*target);
+    }
+    return make_string_buffer(st);
+}
+
 inline buffer wrap_wilton_buffer(char* buf, int buf_len) {
     if (nullptr != buf) {
         return sl::support::make_optional(sl::io::make_span(buf, buf_len));
@@ -68,6 +341,118 @@ inline buffer wrap_wilton_buffer(char* buf, int buf_len) {
     }
 }
 
+/**
+ * Immutable reference-counted buffer, copies share the data,
+ * can be passed between threads and modules as 'wilton_Buffer*'
+ */
+class shared_buffer {
+    wilton_Buffer* handle = nullptr;
+
+public:
+    shared_buffer() { }
+
+    // takes ownership of the handle reference
+    explicit shared_buffer(wilton_Buffer* handle) :
+    handle(handle) { }
+
+    shared_buffer(const shared_buffer& other) :
+    handle(other.handle) {
+        if (nullptr != handle) {
+            wilton_buffer_retain(handle);
+        }
+    }
+
+    shared_buffer& operator=(const shared_buffer& other) {
+        if (handle != other.handle) {
+            reset();
+            handle = other.handle;
+            if (nullptr != handle) {
+                wilton_buffer_retain(handle);
+            }
+        }
+        return *this;
+    }
+
+    shared_buffer(shared_buffer&& other) :
+    handle(other.handle) {
+        other.handle = nullptr;
+    }
+
+    shared_buffer& operator=(shared_buffer&& other) {
+        if (this != std::addressof(other)) {
+            reset();
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+
+    ~shared_buffer() STATICLIB_NOEXCEPT {
+        reset();
+    }
+
+    explicit operator bool() const {
+        return nullptr != handle;
+    }
+
+    sl::io::span<const char> span() const {
+        if (nullptr == handle) {
+            return sl::io::span<const char>();
+        }
+        const char* data = nullptr;
+        int data_len = 0;
+        wilton_buffer_data(handle, std::addressof(data), std::addressof(data_len));
+        return sl::io::make_span(data, data_len);
+    }
+
+    // returns a new reference to be passed to another module
+    wilton_Buffer* retain_handle() const {
+        if (nullptr != handle) {
+            wilton_buffer_retain(handle);
+        }
+        return handle;
+    }
+
+    void reset() STATICLIB_NOEXCEPT {
+        if (nullptr != handle) {
+            wilton_buffer_release(handle);
+            handle = nullptr;
+        }
+    }
+};
+
+// takes ownership of the 'wilton_alloc' allocated 'buf'
+inline shared_buffer make_shared_buffer(char* buf, int buf_len) {
+    if (nullptr == buf) {
+        return shared_buffer();
+    }
+    wilton_Buffer* handle = nullptr;
+    auto err = wilton_buffer_wrap(buf, buf_len, std::addressof(handle));
+    if (nullptr != err) {
+        wilton_free(buf);
+        throw_wilton_error(err, TRACEMSG(err));
+    }
+    return shared_buffer(handle);
+}
+
+inline shared_buffer make_shared_buffer(buffer&& buf) {
+    if (!buf) {
+        return shared_buffer();
+    }
+    auto span = buf.value();
+    buf = make_empty_buffer();
+    return make_shared_buffer(span.data(), static_cast<int> (span.size()));
+}
+
+// copy for the APIs that take ownership of the result
+inline buffer make_array_buffer(const shared_buffer& buf) {
+    if (!buf) {
+        return make_empty_buffer();
+    }
+    auto span = buf.span();
+    return make_array_buffer(span.data(), static_cast<int> (span.size()));
+}
+
 } // namespace
 }
 
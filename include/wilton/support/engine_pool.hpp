@@ -0,0 +1,164 @@
+/*
+ * File:   engine_pool.hpp
+ * Author: alex
+ *
+ * Created on October 19, 2026, 10:15 AM
+ */
+
+#ifndef WILTON_SUPPORT_ENGINE_POOL_HPP
+#define WILTON_SUPPORT_ENGINE_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/io.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace support {
+
+namespace engine_pool_detail {
+
+// engines that can be created, used and destroyed on different threads
+// declare it with 'static bool thread_agile()'
+template<typename Engine>
+class has_thread_agile {
+    template<typename E>
+    static auto check(int) -> decltype(
+            static_cast<bool>(E::thread_agile()),
+            std::true_type());
+
+    template<typename E>
+    static std::false_type check(...);
+
+public:
+    static const bool value = decltype(check<Engine>(0))::value;
+};
+
+template<typename Engine>
+bool engine_thread_agile(std::true_type) {
+    return static_cast<bool>(Engine::thread_agile());
+}
+
+template<typename Engine>
+bool engine_thread_agile(std::false_type) {
+    return false;
+}
+
+} // namespace
+
+// engines are bound to the thread that created them unless they opt in
+template<typename Engine>
+bool is_thread_agile() {
+    return engine_pool_detail::engine_thread_agile<Engine>(std::integral_constant<bool,
+            engine_pool_detail::has_thread_agile<Engine>::value>());
+}
+
+/**
+ * Script engines built ahead of time, to be handed out
+ * to worker threads on their first call; engines are built on the
+ * warm-up threads, so only the engines that return true from
+ * 'static bool thread_agile()' are pooled, warm-up does nothing for others
+ */
+template<typename Engine>
+class engine_pool {
+    std::mutex mutex;
+    std::vector<Engine> engines;
+
+public:
+    engine_pool() { }
+
+    engine_pool(const engine_pool&) = delete;
+
+    engine_pool& operator=(const engine_pool&) = delete;
+
+    /**
+     * Builds engines in parallel with 'factory() -> Engine' and runs the
+     * specified callback scripts on each of them, engines become available
+     * as soon as they are built, returns after all of them are built
+     */
+    template<typename Factory>
+    void warm_up(size_t count, Factory factory, const std::vector<std::string>& warmup_scripts) {
+        if (!is_thread_agile<Engine>()) {
+            return;
+        }
+        auto workers_count = std::min(count, static_cast<size_t>(
+                std::max(1u, std::thread::hardware_concurrency())));
+        std::atomic<size_t> claimed{0};
+        auto error = std::string();
+        auto workers = std::vector<std::thread>();
+        workers.reserve(workers_count);
+        auto deferred = sl::support::defer([&workers, &claimed, count]() STATICLIB_NOEXCEPT {
+            // started workers stop after their current engine when thread creation fails
+            claimed.store(count, std::memory_order_relaxed);
+            for (auto& th : workers) {
+                th.join();
+            }
+        });
+        for (size_t i = 0; i < workers_count; i++) {
+            workers.emplace_back([this, count, &factory, &warmup_scripts, &claimed, &error] {
+                while (claimed.fetch_add(1, std::memory_order_relaxed) < count) {
+                    try {
+                        auto en = factory();
+                        for (auto& sc : warmup_scripts) {
+                            en.run_callback_script(sl::io::make_span(sc.data(), sc.length()));
+                        }
+                        std::lock_guard<std::mutex> guard{mutex};
+                        engines.emplace_back(std::move(en));
+                    } catch (const std::exception& e) {
+                        std::lock_guard<std::mutex> guard{mutex};
+                        if (error.empty()) {
+                            error = e.what();
+                        }
+                        return;
+                    }
+                }
+            });
+        }
+        for (auto& th : workers) {
+            th.join();
+        }
+        workers.clear();
+        if (!error.empty()) {
+            throw exception(TRACEMSG(error + "\nEngine pool warm-up error"));
+        }
+    }
+
+    /**
+     * Passes one of the pooled engines to 'fun(Engine&&)', engine is removed
+     * from the pool before the call and is dropped if 'fun' throws,
+     * returns false if the pool is empty
+     */
+    template<typename Fun>
+    bool take(Fun fun) {
+        std::unique_lock<std::mutex> guard{mutex};
+        if (engines.empty()) {
+            return false;
+        }
+        auto en = std::move(engines.back());
+        engines.pop_back();
+        guard.unlock();
+        fun(std::move(en));
+        return true;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> guard{mutex};
+        return engines.size();
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SUPPORT_ENGINE_POOL_HPP */
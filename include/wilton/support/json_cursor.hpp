@@ -0,0 +1,483 @@
+/*
+ * File:   json_cursor.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 11:05 PM
+ */
+
+#ifndef WILTON_SUPPORT_JSON_CURSOR_HPP
+#define WILTON_SUPPORT_JSON_CURSOR_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace support {
+
+/**
+ * Pull parser over JSON input, values are read one by one
+ * without building a DOM, read values are validated against
+ * JSON grammar, skipped subtrees are not
+ *
+ * usage:
+ *     cur.enter_object();
+ *     while (cur.next_field()) {
+ *         if ("name" == cur.key()) {
+ *             name = cur.read_string();
+ *         } else {
+ *             cur.skip();
+ *         }
+ *     }
+ *     cur.finish();
+ */
+class json_cursor {
+    const char* const begin;
+    const char* const end;
+    const char* pos;
+    // per open container, whether a separator is expected before the next item
+    std::vector<bool> separator_expected;
+    std::string current_key;
+
+public:
+    json_cursor(sl::io::span<const char> data) :
+    begin(data.data()),
+    end(data.data() + data.size()),
+    pos(data.data()) { }
+
+    json_cursor(const json_cursor&) = delete;
+
+    json_cursor& operator=(const json_cursor&) = delete;
+
+    // type of the next value, numbers with fraction or exponent are 'real'
+    sl::json::type peek() {
+        skip_ws();
+        switch (current()) {
+        case '{': return sl::json::type::object;
+        case '[': return sl::json::type::array;
+        case '"': return sl::json::type::string;
+        case 't': case 'f': return sl::json::type::boolean;
+        case 'n': return sl::json::type::nullt;
+        default: break;
+        }
+        auto tok_end = token_end();
+        for (auto it = pos; it < tok_end; ++it) {
+            if ('.' == *it || 'e' == *it || 'E' == *it) {
+                return sl::json::type::real;
+            }
+        }
+        return sl::json::type::integer;
+    }
+
+    void enter_object() {
+        skip_ws();
+        expect('{');
+        separator_expected.push_back(false);
+    }
+
+    // positions the cursor on the next field value, returns false
+    // and leaves the object on closing brace
+    bool next_field() {
+        if (!next_item('}')) {
+            return false;
+        }
+        skip_ws();
+        read_string_into(current_key);
+        skip_ws();
+        expect(':');
+        return true;
+    }
+
+    // key of the field the cursor is positioned on
+    const std::string& key() const {
+        return current_key;
+    }
+
+    void enter_array() {
+        skip_ws();
+        expect('[');
+        separator_expected.push_back(false);
+    }
+
+    // positions the cursor on the next array element, returns false
+    // and leaves the array on closing bracket
+    bool next_element() {
+        return next_item(']');
+    }
+
+    std::string read_string() {
+        auto res = std::string();
+        skip_ws();
+        read_string_into(res);
+        return res;
+    }
+
+    std::string read_string_nonempty(const std::string& name) {
+        auto res = read_string();
+        if (res.empty()) {
+            throw_error("Invalid empty string value for field: [" + name + "]");
+        }
+        return res;
+    }
+
+    int64_t read_int64() {
+        skip_ws();
+        auto tok_end = token_end();
+        auto it = pos;
+        bool negative = false;
+        if (it < tok_end && '-' == *it) {
+            negative = true;
+            ++it;
+        }
+        // no leading zeros in JSON
+        if (it == tok_end || ('0' == *it && tok_end - it > 1)) {
+            throw_error("Invalid integer value");
+        }
+        uint64_t val = 0;
+        const uint64_t limit = negative ?
+                static_cast<uint64_t> (std::numeric_limits<int64_t>::max()) + 1 :
+                static_cast<uint64_t> (std::numeric_limits<int64_t>::max());
+        for (; it < tok_end; ++it) {
+            if (*it < '0' || *it > '9') {
+                throw_error("Invalid integer value");
+            }
+            auto digit = static_cast<uint64_t> (*it - '0');
+            if (val > (limit - digit) / 10) {
+                throw_error("Integer value overflow");
+            }
+            val = val * 10 + digit;
+        }
+        pos = tok_end;
+        if (negative) {
+            return 0 == val ? 0 : -static_cast<int64_t> (val - 1) - 1;
+        }
+        return static_cast<int64_t> (val);
+    }
+
+    double read_double() {
+        skip_ws();
+        auto tok_end = token_end();
+        if (!is_json_number(pos, tok_end)) {
+            throw_error("Invalid number value: [" + std::string(pos, tok_end - pos) + "]");
+        }
+        auto tok = std::string(pos, tok_end - pos);
+        char* parsed_end = nullptr;
+        errno = 0;
+        auto res = std::strtod(tok.c_str(), std::addressof(parsed_end));
+        if (parsed_end != tok.c_str() + tok.length() || ERANGE == errno) {
+            throw_error("Invalid number value: [" + tok + "]");
+        }
+        pos = tok_end;
+        return res;
+    }
+
+    bool read_bool() {
+        skip_ws();
+        if (consume_literal("true")) {
+            return true;
+        }
+        if (consume_literal("false")) {
+            return false;
+        }
+        throw_error("Invalid boolean value");
+        return false;
+    }
+
+    // consumes 'null' and returns true if it is the next value
+    bool read_null() {
+        skip_ws();
+        return consume_literal("null");
+    }
+
+    // loads the next value (possibly a subtree) into DOM
+    sl::json::value read_value() {
+        skip_ws();
+        auto start = pos;
+        skip();
+        return sl::json::load(sl::io::make_span(start, static_cast<size_t> (pos - start)));
+    }
+
+    // skips the next value, nested containers are skipped
+    // by matching brackets without parsing their contents
+    void skip() {
+        skip_ws();
+        auto ch = current();
+        if ('"' == ch) {
+            skip_string();
+            return;
+        }
+        if ('{' != ch && '[' != ch) {
+            auto tok_end = token_end();
+            if (pos == tok_end) {
+                throw_error("Invalid value");
+            }
+            pos = tok_end;
+            return;
+        }
+        size_t depth = 0;
+        while (pos < end) {
+            switch (*pos) {
+            case '"':
+                skip_string();
+                continue;
+            case '{': case '[':
+                depth += 1;
+                break;
+            case '}': case ']':
+                depth -= 1;
+                if (0 == depth) {
+                    ++pos;
+                    return;
+                }
+                break;
+            default:
+                break;
+            }
+            ++pos;
+        }
+        throw_error("Unexpected end of input");
+    }
+
+    // checks that no data is left after the top-level value
+    void finish() {
+        if (!separator_expected.empty()) {
+            throw_error("Unclosed object or array");
+        }
+        skip_ws();
+        if (pos != end) {
+            throw_error("Unexpected trailing data");
+        }
+    }
+
+    size_t position() const {
+        return static_cast<size_t> (pos - begin);
+    }
+
+private:
+    char current() {
+        if (pos >= end) {
+            throw_error("Unexpected end of input");
+        }
+        return *pos;
+    }
+
+    void skip_ws() {
+        while (pos < end && (' ' == *pos || '\n' == *pos || '\r' == *pos || '\t' == *pos)) {
+            ++pos;
+        }
+    }
+
+    void expect(char ch) {
+        if (current() != ch) {
+            throw_error(std::string("Expected: [") + ch + "], found: [" + *pos + "]");
+        }
+        ++pos;
+    }
+
+    const char* token_end() {
+        auto it = pos;
+        while (it < end && ',' != *it && '}' != *it && ']' != *it && ':' != *it &&
+                ' ' != *it && '\n' != *it && '\r' != *it && '\t' != *it) {
+            ++it;
+        }
+        return it;
+    }
+
+    // strict JSON number grammar, 'strtod' alone also accepts hex and infinities
+    static bool is_json_number(const char* it, const char* tok_end) {
+        if (it < tok_end && '-' == *it) {
+            ++it;
+        }
+        if (it == tok_end) {
+            return false;
+        }
+        if ('0' == *it) {
+            ++it;
+        } else if (!consume_digits(it, tok_end)) {
+            return false;
+        }
+        if (it < tok_end && '.' == *it) {
+            ++it;
+            if (!consume_digits(it, tok_end)) {
+                return false;
+            }
+        }
+        if (it < tok_end && ('e' == *it || 'E' == *it)) {
+            ++it;
+            if (it < tok_end && ('+' == *it || '-' == *it)) {
+                ++it;
+            }
+            if (!consume_digits(it, tok_end)) {
+                return false;
+            }
+        }
+        return it == tok_end;
+    }
+
+    static bool consume_digits(const char*& it, const char* tok_end) {
+        auto start = it;
+        while (it < tok_end && *it >= '0' && *it <= '9') {
+            ++it;
+        }
+        return it != start;
+    }
+
+    bool consume_literal(const char* lit) {
+        auto len = std::strlen(lit);
+        if (static_cast<size_t> (end - pos) >= len && 0 == std::memcmp(pos, lit, len) &&
+                token_end() == pos + len) {
+            pos += len;
+            return true;
+        }
+        return false;
+    }
+
+    bool next_item(char closing) {
+        if (separator_expected.empty()) {
+            throw_error("No object or array is entered");
+        }
+        skip_ws();
+        if (closing == current()) {
+            ++pos;
+            separator_expected.pop_back();
+            return false;
+        }
+        if (separator_expected.back()) {
+            expect(',');
+        } else {
+            separator_expected.back() = true;
+        }
+        return true;
+    }
+
+    void skip_string() {
+        expect('"');
+        while (pos < end) {
+            auto ch = *pos;
+            ++pos;
+            if ('"' == ch) {
+                return;
+            }
+            if ('\\' == ch) {
+                ++pos;
+            }
+        }
+        throw_error("Unterminated string");
+    }
+
+    void read_string_into(std::string& out) {
+        expect('"');
+        out.clear();
+        for (;;) {
+            auto start = pos;
+            while (pos < end && '"' != *pos && '\\' != *pos) {
+                if (static_cast<unsigned char> (*pos) < 0x20) {
+                    throw_error("Invalid unescaped control character in string");
+                }
+                ++pos;
+            }
+            out.append(start, pos - start);
+            auto ch = current();
+            ++pos;
+            if ('"' == ch) {
+                return;
+            }
+            read_escape(out);
+        }
+    }
+
+    void read_escape(std::string& out) {
+        auto ch = current();
+        ++pos;
+        switch (ch) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+            uint32_t cp = read_hex4();
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                if (end - pos < 2 || '\\' != pos[0] || 'u' != pos[1]) {
+                    throw_error("Invalid unicode surrogate pair");
+                }
+                pos += 2;
+                auto low = read_hex4();
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    throw_error("Invalid unicode surrogate pair");
+                }
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                throw_error("Invalid unicode surrogate pair");
+            }
+            append_utf8(out, cp);
+            break;
+        }
+        default:
+            throw_error(std::string("Invalid escape character: [") + ch + "]");
+        }
+    }
+
+    uint32_t read_hex4() {
+        if (end - pos < 4) {
+            throw_error("Unexpected end of input");
+        }
+        uint32_t res = 0;
+        for (int i = 0; i < 4; i++) {
+            auto ch = pos[i];
+            res <<= 4;
+            if (ch >= '0' && ch <= '9') {
+                res |= static_cast<uint32_t> (ch - '0');
+            } else if (ch >= 'a' && ch <= 'f') {
+                res |= static_cast<uint32_t> (ch - 'a' + 10);
+            } else if (ch >= 'A' && ch <= 'F') {
+                res |= static_cast<uint32_t> (ch - 'A' + 10);
+            } else {
+                throw_error("Invalid unicode escape");
+            }
+        }
+        pos += 4;
+        return res;
+    }
+
+    static void append_utf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char> (cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char> (0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char> (0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char> (0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char> (0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char> (0x80 | (cp & 0x3F)));
+        } else {
+            out.push_back(static_cast<char> (0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char> (0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char> (0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char> (0x80 | (cp & 0x3F)));
+        }
+    }
+
+    void throw_error(const std::string& msg) {
+        throw exception(TRACEMSG("JSON parse error: " + msg + "," +
+                " position: [" + sl::support::to_string(position()) + "]"));
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SUPPORT_JSON_CURSOR_HPP */
@@ -0,0 +1,246 @@
+/*
+ * File:   json_schema.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 4:40 PM
+ */
+
+#ifndef WILTON_SUPPORT_JSON_SCHEMA_HPP
+#define WILTON_SUPPORT_JSON_SCHEMA_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/json_cursor.hpp"
+
+namespace wilton {
+namespace support {
+
+namespace detail_schema {
+
+const uint8_t empty_slot = 0xFF;
+
+} // namespace
+
+enum class field_kind : uint8_t {
+    string,
+    string_nonempty,
+    integer,
+    // integers are accepted too
+    real,
+    boolean,
+    object,
+    array,
+    any
+};
+
+struct schema_field {
+    const char* name;
+    field_kind kind;
+    bool required;
+};
+
+constexpr schema_field required_field(const char* name, field_kind kind) {
+    return schema_field{name, kind, true};
+}
+
+constexpr schema_field optional_field(const char* name, field_kind kind) {
+    return schema_field{name, kind, false};
+}
+
+/**
+ * Expected fields of a JSON object, field names are looked up with
+ * a perfect hash that is computed once when the schema is created,
+ * schemas are intended to be kept in function-local statics
+ *
+ * usage:
+ *     static const auto schema = support::make_json_schema(
+ *             support::required_field("name", support::field_kind::string_nonempty),
+ *             support::optional_field("directory", support::field_kind::string));
+ *     schema.read_object(cursor, [&](size_t idx, const std::string& key) {
+ *         switch (idx) {
+ *         case 0: name = cursor.read_string_nonempty(key); break;
+ *         case 1: directory = cursor.read_string(); break;
+ *         }
+ *     });
+ */
+template<size_t N>
+class json_schema {
+    static_assert(N > 0 && N <= 64, "Schema must have from 1 to 64 fields");
+
+    std::array<schema_field, N> fields;
+    std::array<size_t, N> names_lens;
+    std::vector<uint8_t> slots;
+    uint32_t seed = 0;
+    uint32_t mask = 0;
+    uint64_t required_mask = 0;
+
+public:
+    template<typename... Fields>
+    explicit json_schema(Fields... schema_fields) :
+    fields{{schema_fields...}} {
+        for (size_t i = 0; i < N; i++) {
+            names_lens[i] = std::strlen(fields[i].name);
+            for (size_t j = 0; j < i; j++) {
+                if (0 == std::strcmp(fields[i].name, fields[j].name)) {
+                    throw exception(TRACEMSG("Invalid duplicate schema field: [" + std::string(fields[i].name) + "]"));
+                }
+            }
+            if (fields[i].required) {
+                required_mask |= static_cast<uint64_t>(1) << i;
+            }
+        }
+        build_table();
+    }
+
+    // index of the field in schema, -1 for unknown names
+    int find(const char* name, size_t name_len) const STATICLIB_NOEXCEPT {
+        auto idx = slots[hash(name, name_len, seed) & mask];
+        if (detail_schema::empty_slot == idx || names_lens[idx] != name_len ||
+                0 != std::memcmp(fields[idx].name, name, name_len)) {
+            return -1;
+        }
+        return static_cast<int>(idx);
+    }
+
+    int find(const std::string& name) const STATICLIB_NOEXCEPT {
+        return find(name.data(), name.length());
+    }
+
+    const schema_field& field_at(size_t idx) const {
+        return fields[idx];
+    }
+
+    /**
+     * Checks field types and names of a loaded object, unknown
+     * fields and missing required fields are reported as errors
+     */
+    void validate(const std::vector<sl::json::field>& obj, const std::string& object_name) const {
+        uint64_t seen = 0;
+        for (const sl::json::field& fi : obj) {
+            auto& name = fi.name();
+            auto idx = find(name);
+            if (idx < 0) {
+                throw exception(TRACEMSG(
+                        "Unknown data field: [" + name + "] in object: [" + object_name + "]"));
+            }
+            if (!kind_matches(fields[idx].kind, fi.json_type()) ||
+                    (field_kind::string_nonempty == fields[idx].kind && fi.as_string().empty())) {
+                throw exception(TRACEMSG("Invalid '" + name + "' field,"
+                        " type: [" + sl::json::stringify_json_type(fi.json_type()) + "]," +
+                        " value: [" + fi.val().dumps() + "]"));
+            }
+            seen |= static_cast<uint64_t>(1) << idx;
+        }
+        check_required(seen, object_name);
+    }
+
+    /**
+     * Reads an object from the cursor, 'fun(size_t idx, const std::string& key)'
+     * is called for every field with the cursor positioned on its value and must
+     * consume that value, value type is checked before the call
+     */
+    template<typename Fun>
+    void read_object(json_cursor& cur, Fun fun, const std::string& object_name = "") const {
+        uint64_t seen = 0;
+        cur.enter_object();
+        while (cur.next_field()) {
+            auto& key = cur.key();
+            auto idx = find(key);
+            if (idx < 0) {
+                throw exception(TRACEMSG("Unknown data field: [" + key + "]" +
+                        (object_name.empty() ? std::string() : " in object: [" + object_name + "]")));
+            }
+            auto type = cur.peek();
+            if (!kind_matches(fields[idx].kind, type)) {
+                throw exception(TRACEMSG("Invalid '" + key + "' field,"
+                        " type: [" + sl::json::stringify_json_type(type) + "]"));
+            }
+            fun(static_cast<size_t>(idx), key);
+            seen |= static_cast<uint64_t>(1) << idx;
+        }
+        check_required(seen, object_name);
+    }
+
+private:
+    static uint32_t hash(const char* name, size_t name_len, uint32_t seed) STATICLIB_NOEXCEPT {
+        uint32_t res = 2166136261u ^ seed;
+        for (size_t i = 0; i < name_len; i++) {
+            res ^= static_cast<uint8_t>(name[i]);
+            res *= 16777619u;
+        }
+        return res ^ (res >> 15);
+    }
+
+    static bool kind_matches(field_kind kind, sl::json::type type) STATICLIB_NOEXCEPT {
+        switch (kind) {
+        case field_kind::string:
+        case field_kind::string_nonempty: return sl::json::type::string == type;
+        case field_kind::integer: return sl::json::type::integer == type;
+        case field_kind::real: return sl::json::type::real == type || sl::json::type::integer == type;
+        case field_kind::boolean: return sl::json::type::boolean == type;
+        case field_kind::object: return sl::json::type::object == type;
+        case field_kind::array: return sl::json::type::array == type;
+        case field_kind::any: return true;
+        }
+        return false;
+    }
+
+    // smallest power of two table with at least twice the fields,
+    // grown until a collision-free seed is found
+    void build_table() {
+        for (size_t size = 2; ; size <<= 1) {
+            if (size < N * 2) {
+                continue;
+            }
+            mask = static_cast<uint32_t>(size - 1);
+            for (uint32_t sd = 0; sd < 1024; sd++) {
+                slots.assign(size, detail_schema::empty_slot);
+                bool collision = false;
+                for (size_t i = 0; i < N && !collision; i++) {
+                    auto& slot = slots[hash(fields[i].name, names_lens[i], sd) & mask];
+                    if (detail_schema::empty_slot != slot) {
+                        collision = true;
+                    } else {
+                        slot = static_cast<uint8_t>(i);
+                    }
+                }
+                if (!collision) {
+                    seed = sd;
+                    return;
+                }
+            }
+        }
+    }
+
+    void check_required(uint64_t seen, const std::string& object_name) const {
+        auto missing = required_mask & ~seen;
+        if (0 == missing) {
+            return;
+        }
+        for (size_t i = 0; i < N; i++) {
+            if (0 != (missing & (static_cast<uint64_t>(1) << i))) {
+                throw exception(TRACEMSG("Required field: '" + std::string(fields[i].name) +
+                        "' is not supplied" +
+                        (object_name.empty() ? std::string() : " in object: [" + object_name + "]")));
+            }
+        }
+    }
+};
+
+template<typename... Fields>
+json_schema<sizeof...(Fields)> make_json_schema(Fields... fields) {
+    return json_schema<sizeof...(Fields)>(fields...);
+}
+
+} // namespace
+}
+
+#endif /* WILTON_SUPPORT_JSON_SCHEMA_HPP */
@@ -0,0 +1,303 @@
+/*
+ * File:   json_view.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 11:20 AM
+ */
+
+#ifndef WILTON_SUPPORT_JSON_VIEW_HPP
+#define WILTON_SUPPORT_JSON_VIEW_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/json_cursor.hpp"
+
+namespace wilton {
+namespace support {
+
+class json_node;
+
+/**
+ * Read-only view over a validated JSON input and its structural index
+ * (see 'wilton_json_index_get'), fields are looked up by jumping over
+ * sibling values, scalars are parsed only when read
+ */
+class json_view {
+    const char* data;
+    size_t data_len;
+    const int* offsets;
+    const int* next;
+    int count;
+
+public:
+    json_view(sl::io::span<const char> data, const int* offsets, const int* next, int count) :
+    data(data.data()),
+    data_len(data.size()),
+    offsets(offsets),
+    next(next),
+    count(count) { }
+
+    json_view(const json_view&) = delete;
+
+    json_view& operator=(const json_view&) = delete;
+
+    json_node root() const;
+
+    char char_at(int idx) const {
+        return data[offsets[idx]];
+    }
+
+    int offset_at(int idx) const {
+        return offsets[idx];
+    }
+
+    int next_at(int idx) const {
+        return next[idx];
+    }
+
+    // raw bytes of the value starting at the entry, without trailing whitespace
+    sl::io::span<const char> raw_at(int idx) const {
+        auto begin = static_cast<size_t>(offsets[idx]);
+        auto end = next[idx] < count ? static_cast<size_t>(offsets[next[idx]]) : data_len;
+        while (end > begin && (' ' == data[end - 1] || '\n' == data[end - 1] ||
+                '\r' == data[end - 1] || '\t' == data[end - 1])) {
+            end -= 1;
+        }
+        return sl::io::make_span(data + begin, end - begin);
+    }
+
+    // key of the field whose name starts at the entry, escaped keys are compared after unescaping
+    bool key_equals(int idx, const std::string& key) const {
+        auto begin = static_cast<size_t>(offsets[idx]) + 1;
+        // closing quote is the last non-whitespace character before ':'
+        auto end = static_cast<size_t>(offsets[idx + 1]);
+        while ('"' != data[end - 1]) {
+            end -= 1;
+        }
+        end -= 1;
+        auto raw = data + begin;
+        auto raw_len = end - begin;
+        if (nullptr == std::memchr(raw, '\\', raw_len)) {
+            return raw_len == key.length() && 0 == std::memcmp(raw, key.data(), raw_len);
+        }
+        json_cursor cur{sl::io::make_span(data + begin - 1, raw_len + 2)};
+        return key == cur.read_string();
+    }
+
+    std::string key_at(int idx) const {
+        auto span = raw_at(idx);
+        json_cursor cur{span};
+        return cur.read_string();
+    }
+
+    int size() const {
+        return count;
+    }
+};
+
+/**
+ * Value inside of a 'json_view', missing fields and out of range elements
+ * are represented with nodes for which 'exists()' returns false
+ */
+class json_node {
+    const json_view* view;
+    int idx;
+
+public:
+    json_node(const json_view* view, int idx) :
+    view(view),
+    idx(idx) { }
+
+    bool exists() const {
+        return idx >= 0;
+    }
+
+    // 'nullt' for missing values, numbers with fraction or exponent are 'real'
+    sl::json::type json_type() const {
+        if (!exists()) {
+            return sl::json::type::nullt;
+        }
+        switch (view->char_at(idx)) {
+        case '{': return sl::json::type::object;
+        case '[': return sl::json::type::array;
+        case '"': return sl::json::type::string;
+        case 't': case 'f': return sl::json::type::boolean;
+        case 'n': return sl::json::type::nullt;
+        default: break;
+        }
+        auto span = raw();
+        for (auto ch : span) {
+            if ('.' == ch || 'e' == ch || 'E' == ch) {
+                return sl::json::type::real;
+            }
+        }
+        return sl::json::type::integer;
+    }
+
+    // field of an object, missing node for other types
+    json_node operator[](const std::string& key) const {
+        if (!exists() || '{' != view->char_at(idx)) {
+            return json_node(view, -1);
+        }
+        int it = idx + 1;
+        while ('}' != view->char_at(it)) {
+            // entries: key, ':', value, then ',' or '}'
+            if (view->key_equals(it, key)) {
+                return json_node(view, it + 2);
+            }
+            it = view->next_at(it + 2);
+            if (',' == view->char_at(it)) {
+                it += 1;
+            }
+        }
+        return json_node(view, -1);
+    }
+
+    // element of an array, missing node for other types or out of range
+    json_node operator[](size_t pos) const {
+        if (!exists() || '[' != view->char_at(idx)) {
+            return json_node(view, -1);
+        }
+        int it = idx + 1;
+        size_t current = 0;
+        while (']' != view->char_at(it)) {
+            if (current == pos) {
+                return json_node(view, it);
+            }
+            it = view->next_at(it);
+            if (',' == view->char_at(it)) {
+                it += 1;
+            }
+            current += 1;
+        }
+        return json_node(view, -1);
+    }
+
+    // number of object fields or array elements
+    size_t size() const {
+        size_t res = 0;
+        for_each_child([&res](int) {
+            res += 1;
+        });
+        return res;
+    }
+
+    // fun(const std::string& key, const json_node& value)
+    template<typename Fun>
+    void for_each_field(Fun fun) const {
+        if (!exists() || '{' != view->char_at(idx)) {
+            return;
+        }
+        for_each_child([this, &fun](int key_idx) {
+            fun(view->key_at(key_idx), json_node(view, key_idx + 2));
+        });
+    }
+
+    // fun(const json_node& element)
+    template<typename Fun>
+    void for_each_element(Fun fun) const {
+        if (!exists() || '[' != view->char_at(idx)) {
+            return;
+        }
+        for_each_child([this, &fun](int el_idx) {
+            fun(json_node(view, el_idx));
+        });
+    }
+
+    std::string as_string_or_throw(const std::string& name = "") const {
+        check_type(sl::json::type::string, name);
+        json_cursor cur{raw()};
+        return cur.read_string();
+    }
+
+    std::string as_string_nonempty_or_throw(const std::string& name = "") const {
+        auto res = as_string_or_throw(name);
+        if (res.empty()) {
+            throw exception(TRACEMSG("Invalid empty string value for field: [" + name + "]"));
+        }
+        return res;
+    }
+
+    int64_t as_int64_or_throw(const std::string& name = "") const {
+        check_type(sl::json::type::integer, name);
+        json_cursor cur{raw()};
+        return cur.read_int64();
+    }
+
+    double as_double_or_throw(const std::string& name = "") const {
+        auto type = json_type();
+        if (sl::json::type::integer != type) {
+            check_type(sl::json::type::real, name);
+        }
+        json_cursor cur{raw()};
+        return cur.read_double();
+    }
+
+    bool as_bool_or_throw(const std::string& name = "") const {
+        check_type(sl::json::type::boolean, name);
+        json_cursor cur{raw()};
+        return cur.read_bool();
+    }
+
+    // raw JSON bytes of the value, empty for missing values
+    sl::io::span<const char> raw() const {
+        if (!exists()) {
+            return sl::io::make_span(static_cast<const char*>(nullptr), 0);
+        }
+        return view->raw_at(idx);
+    }
+
+    // loads the value (possibly a subtree) into DOM
+    sl::json::value to_value() const {
+        if (!exists()) {
+            return sl::json::value();
+        }
+        return sl::json::load(raw());
+    }
+
+private:
+    // calls fun(entry_index) for each field key or array element
+    template<typename Fun>
+    void for_each_child(Fun fun) const {
+        if (!exists()) {
+            return;
+        }
+        auto open = view->char_at(idx);
+        if ('{' != open && '[' != open) {
+            return;
+        }
+        int it = idx + 1;
+        while ('}' != view->char_at(it) && ']' != view->char_at(it)) {
+            fun(it);
+            it = '{' == open ? view->next_at(it + 2) : view->next_at(it);
+            if (',' == view->char_at(it)) {
+                it += 1;
+            }
+        }
+    }
+
+    void check_type(sl::json::type expected, const std::string& name) const {
+        auto type = json_type();
+        if (expected != type || !exists()) {
+            throw exception(TRACEMSG("Invalid value type for field: [" + name + "]," +
+                    " expected: [" + sl::json::stringify_json_type(expected) + "]," +
+                    " actual: [" + (exists() ? sl::json::stringify_json_type(type) : std::string("undefined")) + "]"));
+        }
+    }
+};
+
+inline json_node json_view::root() const {
+    return json_node(this, 0);
+}
+
+} // namespace
+}
+
+#endif /* WILTON_SUPPORT_JSON_VIEW_HPP */
@@ -14,6 +14,7 @@
 #include "wilton/wilton.h"
 
 #include "wilton/support/exception.hpp"
+#include "wilton/support/json_schema.hpp"
 
 namespace wilton {
 namespace support {
@@ -28,43 +29,12 @@ inline void check_json_callback_script(const sl::json::field& field) {
                 " type: [" + sl::json::stringify_json_type(field.json_type()) + "]," +
                 " value: [" + field.val().dumps() + "]"));
     }
-    bool module = false;
-    for (const sl::json::field& fi : field.as_object()) {
-        auto& name = fi.name();
-        if ("module" == name) {
-            if (sl::json::type::string != fi.json_type()) {
-                throw support::exception(TRACEMSG("Invalid '" + fi.name() + "' field,"
-                        " type: [" + sl::json::stringify_json_type(fi.json_type()) + "]," +
-                        " value: [" + fi.val().dumps() + "]"));
-            }
-            module = true;
-        } else if ("func" == name) {
-            if (sl::json::type::string != fi.json_type()) {
-                throw support::exception(TRACEMSG("Invalid '" + fi.name() + "' field,"
-                        " type: [" + sl::json::stringify_json_type(fi.json_type()) + "]," +
-                        " value: [" + fi.val().dumps() + "]"));
-            }
-        } else if ("args" == name) {
-            if (sl::json::type::array != fi.json_type()) {
-                throw support::exception(TRACEMSG("Invalid '" + fi.name() + "' field,"
-                        " type: [" + sl::json::stringify_json_type(fi.json_type()) + "]," +
-                        " value: [" + fi.val().dumps() + "]"));
-            }
-        } else if ("engine" == name) {
-            if (sl::json::type::string != fi.json_type()) {
-                throw support::exception(TRACEMSG("Invalid '" + fi.name() + "' field,"
-                        " type: [" + sl::json::stringify_json_type(fi.json_type()) + "]," +
-                        " value: [" + fi.val().dumps() + "]"));
-            }
-        } else {
-            throw support::exception(TRACEMSG(
-                    "Unknown data field: [" + name + "] in object: [" + field.name() + "]"));
-        }
-    }
-    if (!module) {
-        throw support::exception(TRACEMSG(
-                "Required field: 'module' is not supplied in object: [" + field.name() + "]"));
-    }
+    static const auto schema = make_json_schema(
+            required_field("module", field_kind::string),
+            optional_field("func", field_kind::string),
+            optional_field("args", field_kind::array),
+            optional_field("engine", field_kind::string));
+    schema.validate(field.as_object(), field.name());
 }
 
 } // namespace
@@ -8,6 +8,7 @@
 #ifndef WILTON_SUPPORT_REGISTRAR_HPP
 #define WILTON_SUPPORT_REGISTRAR_HPP
 
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -18,6 +19,8 @@
 #include "wilton/support/alloc_copy.hpp"
 #include "wilton/support/buffer.hpp"
 #include "wilton/support/exception.hpp"
+#include "wilton/support/json_cursor.hpp"
+#include "wilton/support/json_view.hpp"
 
 namespace wilton {
 namespace support {
@@ -33,10 +36,21 @@ using cb_type = char* (*)(
 
 using fun_span_type = support::buffer(*)(sl::io::span<const char>);
 
-inline char* cb_fun(void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len) {
-    auto fun = reinterpret_cast<fun_span_type> (call_ctx);
+using fun_cursor_type = support::buffer(*)(json_cursor&);
+
+using fun_view_type = support::buffer(*)(const json_view&);
+
+template<typename Fun, typename Input>
+char* call_fun(Fun fun, Input& input, char** json_out, int* json_out_len) {
+    // target of an outer 'into' call must not be used by this call
+    auto& target = detail_buffer::current_into_target();
+    auto outer = target;
+    target = nullptr;
+    auto deferred = sl::support::defer([&target, outer]() STATICLIB_NOEXCEPT {
+        target = outer;
+    });
     try {
-        auto out = fun({json_in, json_in_len});
+        auto out = fun(input);
         if (out) {
             *json_out = out.value().data();
             *json_out_len = static_cast<int> (out.value().size());
@@ -50,6 +64,114 @@ inline char* cb_fun(void* call_ctx, const char* json_in, int json_in_len, char**
     }
 }
 
+inline char* cb_fun(void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len) {
+    auto fun = reinterpret_cast<fun_span_type> (call_ctx);
+    auto span = sl::io::span<const char>(json_in, json_in_len);
+    return call_fun(fun, span, json_out, json_out_len);
+}
+
+inline char* cb_fun_cursor(void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len) {
+    auto fun = reinterpret_cast<fun_cursor_type> (call_ctx);
+    json_cursor cursor{sl::io::span<const char>(json_in, json_in_len)};
+    return call_fun(fun, cursor, json_out, json_out_len);
+}
+
+// index is reused by the calls on the same thread, nested calls get their own
+struct thread_json_index {
+    wilton_JsonIndex* index = nullptr;
+    bool in_use = false;
+
+    ~thread_json_index() STATICLIB_NOEXCEPT {
+        if (nullptr != index) {
+            auto err = wilton_json_index_destroy(index);
+            wilton_free(err);
+        }
+    }
+};
+
+inline thread_json_index& current_json_index() {
+    static thread_local thread_json_index ti;
+    return ti;
+}
+
+inline char* cb_fun_view(void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len) {
+    auto fun = reinterpret_cast<fun_view_type> (call_ctx);
+    auto& ti = current_json_index();
+    bool shared = !ti.in_use;
+    wilton_JsonIndex* index = shared ? ti.index : nullptr;
+    if (nullptr == index) {
+        auto err_create = wilton_json_index_create(std::addressof(index));
+        if (nullptr != err_create) {
+            return err_create;
+        }
+        if (shared) {
+            ti.index = index;
+        }
+    }
+    ti.in_use = true;
+    auto deferred = sl::support::defer([&ti, index, shared]() STATICLIB_NOEXCEPT {
+        if (shared) {
+            ti.in_use = false;
+        } else {
+            auto err = wilton_json_index_destroy(index);
+            wilton_free(err);
+        }
+    });
+    auto err_build = wilton_json_index_build(index, json_in, json_in_len);
+    if (nullptr != err_build) {
+        return err_build;
+    }
+    const int* offsets = nullptr;
+    const int* next = nullptr;
+    int count = 0;
+    auto err_get = wilton_json_index_get(index, std::addressof(offsets), std::addressof(next), std::addressof(count));
+    if (nullptr != err_get) {
+        return err_get;
+    }
+    json_view view{sl::io::span<const char>(json_in, json_in_len), offsets, next, count};
+    return call_fun(fun, view, json_out, json_out_len);
+}
+
+inline void register_cb(const std::string& name, void* call_ctx, cb_type cb) {
+    auto err = wiltoncall_register(name.c_str(), static_cast<int> (name.length()), call_ctx, cb);
+    if (nullptr != err) {
+        auto msg = TRACEMSG(err);
+        wilton_free(err);
+        throw exception(msg);
+    }
+}
+
+inline char* cb_fun_into(void* call_ctx, const char* json_in, int json_in_len,
+        char* out_buf, int out_buf_cap, int* json_out_len) {
+    auto fun = reinterpret_cast<fun_span_type> (call_ctx);
+    auto into = detail_buffer::into_target(out_buf, static_cast<size_t> (out_buf_cap));
+    auto& target = detail_buffer::current_into_target();
+    auto outer = target;
+    target = std::addressof(into);
+    auto deferred = sl::support::defer([&target, outer]() STATICLIB_NOEXCEPT {
+        target = outer;
+    });
+    try {
+        auto out = fun({json_in, json_in_len});
+        if (!out) {
+            *json_out_len = 0;
+        } else if (into.used && out.value().data() == out_buf) {
+            *json_out_len = static_cast<int> (into.len);
+        } else {
+            // created without the result helpers
+            auto len = out.value().size();
+            if (len <= into.cap) {
+                std::memcpy(out_buf, out.value().data(), len);
+            }
+            wilton_free(out.value().data());
+            *json_out_len = static_cast<int> (len);
+        }
+        return nullptr;
+    } catch (const std::exception& e) {
+        return alloc_copy(TRACEMSG(e.what()));
+    }
+}
+
 } // namespace
 
 inline void register_wiltoncall(const std::string& name, detail_registrar::fun_span_type fun) {
@@ -57,8 +179,72 @@ inline void register_wiltoncall(const std::string& name, detail_registrar::fun_s
         throw exception(TRACEMSG("Registrar error, invalid empty function specified," +
                 " name: [" + name + "]"));
     }
-    auto err = wiltoncall_register(name.c_str(), static_cast<int> (name.length()), 
-            reinterpret_cast<void*> (fun), detail_registrar::cb_fun);
+    detail_registrar::register_cb(name, reinterpret_cast<void*> (fun), detail_registrar::cb_fun);
+}
+
+// function receives a pull parser over the input instead of the raw span,
+// to read only the needed fields without loading the input into DOM
+inline void register_wiltoncall(const std::string& name, detail_registrar::fun_cursor_type fun) {
+    if (nullptr == fun) {
+        throw exception(TRACEMSG("Registrar error, invalid empty function specified," +
+                " name: [" + name + "]"));
+    }
+    detail_registrar::register_cb(name, reinterpret_cast<void*> (fun), detail_registrar::cb_fun_cursor);
+}
+
+// input is validated and indexed with the vectorized scanner before the call,
+// function navigates it with a view instead of loading it into DOM
+inline void register_wiltoncall(const std::string& name, detail_registrar::fun_view_type fun) {
+    if (nullptr == fun) {
+        throw exception(TRACEMSG("Registrar error, invalid empty function specified," +
+                " name: [" + name + "]"));
+    }
+    detail_registrar::register_cb(name, reinterpret_cast<void*> (fun), detail_registrar::cb_fun_view);
+}
+
+// function accepts and produces payloads encoded with 'payload_format' ('WILTONCALL_FORMAT_*'),
+// callers that use other format get their payloads transcoded by the core
+inline void register_wiltoncall_format(const std::string& name, detail_registrar::fun_span_type fun,
+        int payload_format) {
+    if (nullptr == fun) {
+        throw exception(TRACEMSG("Registrar error, invalid empty function specified," +
+                " name: [" + name + "]"));
+    }
+    auto err = wiltoncall_register_format(name.c_str(), static_cast<int> (name.length()),
+            reinterpret_cast<void*> (fun), detail_registrar::cb_fun, payload_format);
+    if (nullptr != err) {
+        auto msg = TRACEMSG(err);
+        wilton_free(err);
+        throw exception(msg);
+    }
+}
+
+// results of the function are cached by input, zero TTL means no expiration
+inline void register_wiltoncall_cacheable(const std::string& name, detail_registrar::fun_span_type fun,
+        int ttl_millis, int max_entries) {
+    if (nullptr == fun) {
+        throw exception(TRACEMSG("Registrar error, invalid empty function specified," +
+                " name: [" + name + "]"));
+    }
+    auto err = wiltoncall_register_cacheable(name.c_str(), static_cast<int> (name.length()),
+            reinterpret_cast<void*> (fun), detail_registrar::cb_fun, ttl_millis, max_entries);
+    if (nullptr != err) {
+        auto msg = TRACEMSG(err);
+        wilton_free(err);
+        throw exception(msg);
+    }
+}
+
+// result of the function is written directly to the caller buffer of 'wiltoncall_into'
+// when it is created with 'make_json_result' or 'make_string_result', results created
+// otherwise are copied there
+inline void register_wiltoncall_into(const std::string& name, detail_registrar::fun_span_type fun) {
+    if (nullptr == fun) {
+        throw exception(TRACEMSG("Registrar error, invalid empty function specified," +
+                " name: [" + name + "]"));
+    }
+    auto err = wiltoncall_register_into(name.c_str(), static_cast<int> (name.length()),
+            reinterpret_cast<void*> (fun), detail_registrar::cb_fun, detail_registrar::cb_fun_into);
     if (nullptr != err) {
         auto msg = TRACEMSG(err);
         wilton_free(err);
@@ -8,10 +8,20 @@
 #ifndef WILTON_SUPPORT_SCRIPT_ENGINE_HPP
 #define WILTON_SUPPORT_SCRIPT_ENGINE_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "staticlib/config.hpp"
 #include "staticlib/io.hpp"
@@ -21,7 +31,9 @@
 #include "wilton/wilton.h"
 #include "wilton/wilton_loader.h"
 
+#include "wilton/support/alloc_copy.hpp"
 #include "wilton/support/buffer.hpp"
+#include "wilton/support/engine_pool.hpp"
 #include "wilton/support/exception.hpp"
 #include "wilton/support/misc.hpp"
 
@@ -43,10 +55,24 @@ inline sl::json::value load_wilton_config() {
     return json;
 }
 
+// loads a single value without parsing the whole config
+inline sl::json::value load_wilton_config_value(const std::string& path) {
+    char* val = nullptr;
+    int val_len = 0;
+    auto err = wilton_config_get(path.c_str(), static_cast<int>(path.length()),
+            std::addressof(val), std::addressof(val_len));
+    if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
+    auto deferred = sl::support::defer([val] () STATICLIB_NOEXCEPT {
+        wilton_free(val);
+    });
+    const char* cval = const_cast<const char*>(val);
+    return sl::json::load({cval, val_len});
+}
+
 inline sl::io::span<const char> load_init_code() {
     static const std::string code = [] {
-        auto json = load_wilton_config();
-        auto requirejs_dir_path = json["requireJs"]["baseUrl"].as_string_nonempty_or_throw("requireJs.baseUrl") + "/wilton-requirejs";
+        auto base_url = load_wilton_config_value("requireJs.baseUrl");
+        auto requirejs_dir_path = base_url.as_string_nonempty_or_throw("requireJs.baseUrl") + "/wilton-requirejs";
         auto code_path = requirejs_dir_path + "/wilton-require.js";
         char* code = nullptr;
         int code_len = 0;
@@ -63,9 +89,10 @@ inline sl::io::span<const char> load_init_code() {
 }
 
 inline std::string shorten_script_path(const std::string& path) {
-    static sl::json::value json = load_wilton_config();
+    static const sl::json::value base_url_json = load_wilton_config_value("requireJs.baseUrl");
+    static const sl::json::value paths_json = load_wilton_config_value("requireJs.paths");
     // check stdlib path
-    auto& base_url = json["requireJs"]["baseUrl"].as_string_nonempty_or_throw("requireJs.baseUrl");
+    auto& base_url = base_url_json.as_string_nonempty_or_throw("requireJs.baseUrl");
     if (sl::utils::starts_with(path, base_url)) {
         auto shortened = path.substr(base_url.length());
         if (shortened.length() > 1 && '/' == shortened.at(0)) {
@@ -74,7 +101,6 @@ inline std::string shorten_script_path(const std::string& path) {
         return shortened;
     }
     // check app paths
-    auto& paths_json = json["requireJs"]["paths"];
     if (sl::json::type::object == paths_json.json_type()) {
         for (auto& fi : paths_json.as_object()) {
             const std::string& app_id = fi.name();
@@ -91,41 +117,709 @@ inline std::string shorten_script_path(const std::string& path) {
     return path;
 }
 
+inline void trace_engine_event(bool begin) STATICLIB_NOEXCEPT {
+    static const std::string category = "engine";
+    static const std::string name = "create";
+    auto fun = begin ? wilton_trace_begin : wilton_trace_end;
+    auto err = fun(category.c_str(), static_cast<int>(category.length()),
+            name.c_str(), static_cast<int>(name.length()));
+    if (nullptr != err) {
+        wilton_free(err);
+    }
+}
+
+inline sl::io::span<const char> empty_span() {
+    return sl::io::make_span(static_cast<const char*>(nullptr), 0);
+}
+
+inline bool snapshot_cache_enabled() STATICLIB_NOEXCEPT {
+    int enabled = 0;
+    auto err = wilton_snapshot_enabled(std::addressof(enabled));
+    if (nullptr != err) {
+        wilton_free(err);
+        return false;
+    }
+    return 0 != enabled;
+}
+
+// cache errors are not fatal, engine is created without snapshot
+inline sl::io::span<const char> load_snapshot(const std::string& name, const std::string& version) {
+    const char* data = nullptr;
+    int data_len = 0;
+    auto err = wilton_snapshot_load(name.c_str(), static_cast<int>(name.length()),
+            version.c_str(), static_cast<int>(version.length()),
+            std::addressof(data), std::addressof(data_len));
+    if (nullptr != err) {
+        wilton_free(err);
+        return empty_span();
+    }
+    return sl::io::make_span(data, static_cast<size_t>(data_len));
+}
+
+inline void store_snapshot(const std::string& name, const std::string& version, const std::string& data) {
+    auto err = wilton_snapshot_store(name.c_str(), static_cast<int>(name.length()),
+            version.c_str(), static_cast<int>(version.length()),
+            data.data(), static_cast<int>(data.length()));
+    if (nullptr != err) {
+        wilton_free(err);
+    }
+}
+
+inline void remove_snapshot(const std::string& name) STATICLIB_NOEXCEPT {
+    auto err = wilton_snapshot_remove(name.c_str(), static_cast<int>(name.length()));
+    if (nullptr != err) {
+        wilton_free(err);
+    }
+}
+
+// snapshots are invalidated when init code changes
+inline std::string init_code_digest(sl::io::span<const char> code) {
+    uint64_t res = 14695981039346656037ull;
+    for (auto ch : code) {
+        res ^= static_cast<uint8_t>(ch);
+        res *= 1099511628211ull;
+    }
+    static const char* hex = "0123456789abcdef";
+    auto st = std::string();
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        st.push_back(hex[(res >> shift) & 0xf]);
+    }
+    return st;
+}
+
+// engines that can be created from a snapshot of their init code
+template<typename Engine>
+class has_snapshot_support {
+    template<typename E>
+    static auto check(int) -> decltype(
+            std::string(E::snapshot_name()),
+            std::string(E::snapshot_version()),
+            std::string(E::create_snapshot(std::declval<sl::io::span<const char>>())),
+            E(std::declval<sl::io::span<const char>>(), std::declval<sl::io::span<const char>>()),
+            std::true_type());
+
+    template<typename E>
+    static std::false_type check(...);
+
+public:
+    static const bool value = decltype(check<Engine>(0))::value;
+};
+
+// engines that report the size of their heap, 'heap_size()'
+// is called after every script call and must be cheap
+template<typename Engine>
+class has_heap_size {
+    template<typename E>
+    static auto check(int) -> decltype(
+            static_cast<uint64_t>(std::declval<const E&>().heap_size()),
+            std::true_type());
+
+    template<typename E>
+    static std::false_type check(...);
+
+public:
+    static const bool value = decltype(check<Engine>(0))::value;
+};
+
+template<typename Engine>
+uint64_t engine_heap_size(const Engine& en, std::true_type) {
+    return static_cast<uint64_t>(en.heap_size());
+}
+
+template<typename Engine>
+uint64_t engine_heap_size(const Engine&, std::false_type) {
+    return 0;
+}
+
+// engines that can collect garbage between calls, incremental or full
+template<typename Engine>
+class has_collect_garbage {
+    template<typename E>
+    static auto check(int) -> decltype(
+            std::declval<E&>().collect_garbage(true),
+            std::true_type());
+
+    template<typename E>
+    static std::false_type check(...);
+
+public:
+    static const bool value = decltype(check<Engine>(0))::value;
+};
+
+template<typename Engine>
+void engine_collect_garbage(Engine& en, bool full, std::true_type) {
+    en.collect_garbage(full);
+}
+
+template<typename Engine>
+void engine_collect_garbage(Engine&, bool, std::false_type) { }
+
+inline uint64_t now_micros() STATICLIB_NOEXCEPT {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+inline uint64_t now_millis() STATICLIB_NOEXCEPT {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+inline uint64_t next_map_id() STATICLIB_NOEXCEPT {
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// shared by the map entry and the thread cache, so it outlives evicted engines;
+// 'busy' counts nested calls, engines are evicted only when it is zero;
+// 'collecting' is set while idle GC runs on the scheduler thread
+struct engine_state {
+    std::atomic<uint32_t> busy{0};
+    std::atomic<bool> collecting{false};
+    std::atomic<uint64_t> last_used{now_millis()};
+    std::atomic<uint64_t> heap_size{0};
+    // 0 - none since the last call, 1 - incremental, 2 - full
+    std::atomic<uint32_t> gc_level{0};
+};
+
+// calls on the engine wait for idle GC that started before them, the wait
+// is bounded by a single 'collect_garbage' call, as the scheduler does not
+// start another one while the engine is busy; returns microseconds waited
+inline uint64_t wait_collected(engine_state& state) STATICLIB_NOEXCEPT {
+    if (!state.collecting.load(std::memory_order_seq_cst)) {
+        return 0;
+    }
+    auto start = now_micros();
+    for (uint32_t spins = 0; state.collecting.load(std::memory_order_seq_cst); spins++) {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    return std::max<uint64_t>(1, now_micros() - start);
+}
+
+template<typename Engine>
+struct engine_entry {
+    Engine engine;
+    std::shared_ptr<engine_state> state;
+
+    explicit engine_entry(Engine&& engine) :
+    engine(std::move(engine)),
+    state(std::make_shared<engine_state>()) { }
+};
+
+// engine of the current thread as of the specified map generation
+template<typename Engine>
+struct engine_cache {
+    uint64_t map_id = 0;
+    uint64_t generation = 0;
+    Engine* engine = nullptr;
+    std::shared_ptr<engine_state> state;
+};
+
+// engine marked busy for the duration of the call
+template<typename Engine>
+struct acquired_engine {
+    Engine& engine;
+    engine_state& state;
+};
+
 } // namespace
 
+/**
+ * Script engines of the worker threads; engines that define 'snapshot_name()',
+ * 'snapshot_version()', 'create_snapshot(init_code) -> std::string' statics
+ * and an 'Engine(init_code, snapshot)' constructor are created from a snapshot
+ * that is kept in the snapshot cache (see 'wilton_snapshot_load'), the snapshot
+ * is empty when the cache is disabled; engines that define 'heap_size()'
+ * and are thread agile (see below) are evicted from idle threads (least recently
+ * used first) when their total heap exceeds the memory budget, and are recreated
+ * on the next call;
+ * thread agile engines that define 'collect_garbage(bool full)' are asked to collect
+ * garbage from a background thread after they stay idle for a configured period;
+ * engines are pre-warmed in the pool ('enginePool.size') only when they return
+ * true from 'static bool thread_agile()', as they are built on the warm-up threads
+ */
 template<typename Engine>
 class script_engine_map {
     std::mutex mutex;
-    std::map<std::string, Engine> engines;
-    
+    std::map<std::string, script_engine_map_detail::engine_entry<Engine>> engines;
+    support::engine_pool<Engine> pool;
+    std::function<sl::io::span<const char>()> init_code_loader;
+    // every clean bumps the generation to invalidate
+    // engine pointers cached by running threads
+    const uint64_t map_id = script_engine_map_detail::next_map_id();
+    std::atomic<uint64_t> generation{0};
+    // zero budget disables eviction
+    std::atomic<uint64_t> memory_budget{0};
+    std::atomic<uint64_t> heap_total{0};
+    std::atomic<uint64_t> creations{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<bool> stats_registered{false};
+    // idle GC scheduler
+    std::thread gc_thread;
+    std::mutex gc_mutex;
+    std::condition_variable gc_cv;
+    bool gc_stop = false;
+    std::atomic<uint64_t> gcs_incremental{0};
+    std::atomic<uint64_t> gcs_full{0};
+    std::atomic<uint64_t> gc_micros{0};
+    std::atomic<uint64_t> gc_waits{0};
+    std::atomic<uint64_t> gc_wait_micros{0};
+    // loaded once, mapped data stays valid until exit
+    std::mutex snapshot_mutex;
+    bool snapshot_checked = false;
+    const char* snapshot_data = nullptr;
+    size_t snapshot_len = 0;
+
 public:
+    script_engine_map() :
+    script_engine_map(script_engine_map_detail::load_init_code) { }
+
+    // init code is loaded lazily, when the first engine is created
+    explicit script_engine_map(std::function<sl::io::span<const char>()> init_code_loader) :
+    init_code_loader(std::move(init_code_loader)) { }
+
+    script_engine_map(const script_engine_map&) = delete;
+
+    script_engine_map& operator=(const script_engine_map&) = delete;
+
+    ~script_engine_map() STATICLIB_NOEXCEPT {
+        if (stats_registered.load()) {
+            auto err = wilton_unregister_engine_stats(this);
+            if (nullptr != err) {
+                wilton_free(err);
+            }
+        }
+        if (gc_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard{gc_mutex};
+                gc_stop = true;
+            }
+            gc_cv.notify_all();
+            gc_thread.join();
+        }
+    }
+
     support::buffer run_script(sl::io::span<const char> callback_script_json) {
-        auto& en = thread_local_engine();
-        return en.run_callback_script(callback_script_json);
+        auto acquired = acquire_engine();
+        auto deferred = sl::support::defer([this, &acquired]() STATICLIB_NOEXCEPT {
+            this->release_engine(acquired);
+        });
+        return acquired.engine.run_callback_script(callback_script_json);
     }
 
     void clean_thread_local(const char* thread_id, int thread_id_len) STATICLIB_NOEXCEPT {
         std::lock_guard<std::mutex> guard{mutex};
         if (nullptr != thread_id && sl::support::is_uint16_positive(thread_id_len)) {
             auto tid = std::string(thread_id, thread_id_len);
-            engines.erase(tid);
+            auto it = engines.find(tid);
+            if (engines.end() != it) {
+                wait_collected(*it->second.state);
+                heap_total.fetch_sub(it->second.state->heap_size.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+                engines.erase(it);
+            }
+            generation.fetch_add(1, std::memory_order_release);
         }
     }
 
-private:
+    /**
+     * Registers the map for 'get_engine_stats' call and applies 'enginePool' config entry:
+     * '{"size": 32, "warmupScripts": [{"module": "app/warmup", "func": "run"}], "memoryBudget": 1073741824,
+     * "idleGcMillis": 500, "idleFullGcMillis": 5000}', 'size' engines are built for the threads
+     * that did not call this map yet, if the engine is thread agile
+     */
+    void init_from_config() {
+        bool the_false = false;
+        if (stats_registered.compare_exchange_strong(the_false, true)) {
+            auto err = wilton_register_engine_stats(this, stats_cb);
+            if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
+        }
+        auto conf = script_engine_map_detail::load_wilton_config_value("enginePool");
+        if (sl::json::type::nullt == conf.json_type()) {
+            return;
+        }
+        auto& budget_json = conf.getattr("memoryBudget");
+        if (sl::json::type::nullt != budget_json.json_type()) {
+            auto budget = budget_json.as_int64_or_throw("enginePool.memoryBudget");
+            if (budget < 0) {
+                throw support::exception(TRACEMSG("Invalid 'enginePool.memoryBudget' field,"
+                        " value: [" + sl::support::to_string(budget) + "]"));
+            }
+            set_memory_budget(static_cast<uint64_t>(budget));
+        }
+        auto& gc_json = conf.getattr("idleGcMillis");
+        if (sl::json::type::nullt != gc_json.json_type()) {
+            auto& full_gc_json = conf.getattr("idleFullGcMillis");
+            auto full_gc_millis = sl::json::type::nullt != full_gc_json.json_type() ?
+                    full_gc_json.as_uint32_positive_or_throw("enginePool.idleFullGcMillis") : 0;
+            start_idle_gc(gc_json.as_uint32_positive_or_throw("enginePool.idleGcMillis"), full_gc_millis);
+        }
+        uint32_t size = 0;
+        auto& size_json = conf.getattr("size");
+        if (sl::json::type::nullt != size_json.json_type()) {
+            size = size_json.as_uint32_or_throw("enginePool.size");
+        }
+        auto scripts = std::vector<std::string>();
+        auto& scripts_json = conf.getattr("warmupScripts");
+        if (sl::json::type::nullt != scripts_json.json_type()) {
+            if (sl::json::type::array != scripts_json.json_type()) {
+                throw support::exception(TRACEMSG("Invalid 'enginePool.warmupScripts' field,"
+                        " type: [" + sl::json::stringify_json_type(scripts_json.json_type()) + "]"));
+            }
+            for (auto& sc : scripts_json.as_array()) {
+                auto fi = sl::json::field("enginePool.warmupScripts", sc.clone());
+                support::check_json_callback_script(fi);
+                scripts.emplace_back(sc.dumps());
+            }
+        }
+        pool.warm_up(size, [this] {
+            return this->create_engine();
+        }, scripts);
+    }
+
+    // zero disables eviction, engines that are not thread agile
+    // are destroyed only on their threads and are never evicted
+    void set_memory_budget(uint64_t budget_bytes) {
+        memory_budget.store(budget_bytes, std::memory_order_relaxed);
+    }
 
-    // no TLS in vs2013
-    Engine& thread_local_engine() {
+    /**
+     * Starts the background thread that asks engines idle for 'gc_millis'
+     * to run incremental GC, and engines idle for 'full_gc_millis' to run
+     * full GC (zero to skip it), each engine is collected once per idle period;
+     * calls that arrive during the collection wait for it and are reported
+     * in stats; does nothing for engines without 'collect_garbage(bool full)'
+     * and for engines that are not thread agile
+     */
+    void start_idle_gc(uint32_t gc_millis, uint32_t full_gc_millis) {
+        // GC runs on the scheduler thread
+        if (!script_engine_map_detail::has_collect_garbage<Engine>::value ||
+                !support::is_thread_agile<Engine>()) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard{gc_mutex};
+        if (gc_thread.joinable()) {
+            throw support::exception(TRACEMSG("Idle GC is already started"));
+        }
+        gc_thread = std::thread([this, gc_millis, full_gc_millis] {
+            this->run_idle_gc(gc_millis, full_gc_millis);
+        });
+    }
+
+    /**
+     * Engine count, heap sizes, creations, evictions and idle GC counters,
+     * reported by 'get_engine_stats' call
+     */
+    sl::json::value stats() {
+        auto now = script_engine_map_detail::now_millis();
+        auto pooled = pool.size();
         std::lock_guard<std::mutex> guard{mutex};
+        auto engines_json = std::vector<sl::json::value>();
+        for (auto& en : engines) {
+            auto& st = *en.second.state;
+            auto busy = 0 != st.busy.load(std::memory_order_relaxed);
+            auto last_used = st.last_used.load(std::memory_order_relaxed);
+            engines_json.emplace_back(sl::json::value({
+                { "thread", en.first },
+                { "heapBytes", static_cast<int64_t>(st.heap_size.load(std::memory_order_relaxed)) },
+                { "idleMillis", static_cast<int64_t>(busy || last_used > now ? 0 : now - last_used) },
+                { "busy", busy }
+            }));
+        }
+        return {
+            { "engineCount", static_cast<int64_t>(engines.size()) },
+            { "pooledCount", static_cast<int64_t>(pooled) },
+            { "heapBytes", static_cast<int64_t>(heap_total.load(std::memory_order_relaxed)) },
+            { "memoryBudget", static_cast<int64_t>(memory_budget.load(std::memory_order_relaxed)) },
+            { "creations", static_cast<int64_t>(creations.load(std::memory_order_relaxed)) },
+            { "evictions", static_cast<int64_t>(evictions.load(std::memory_order_relaxed)) },
+            { "idleGcs", static_cast<int64_t>(gcs_incremental.load(std::memory_order_relaxed)) },
+            { "idleFullGcs", static_cast<int64_t>(gcs_full.load(std::memory_order_relaxed)) },
+            { "idleGcMicros", static_cast<int64_t>(gc_micros.load(std::memory_order_relaxed)) },
+            { "idleGcWaits", static_cast<int64_t>(gc_waits.load(std::memory_order_relaxed)) },
+            { "idleGcWaitMicros", static_cast<int64_t>(gc_wait_micros.load(std::memory_order_relaxed)) },
+            { "engines", std::move(engines_json) }
+        };
+    }
+
+private:
+    static char* stats_cb(void* ctx, char** stats_json_out, int* stats_json_len_out) STATICLIB_NOEXCEPT {
+        try {
+            auto self = static_cast<script_engine_map*>(ctx);
+            auto json = self->stats().dumps();
+            *stats_json_out = support::alloc_copy(json);
+            *stats_json_len_out = static_cast<int>(json.length());
+            return nullptr;
+        } catch (const std::exception& e) {
+            return support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+        }
+    }
+
+    Engine create_engine() {
+        creations.fetch_add(1, std::memory_order_relaxed);
+        auto code = init_code_loader();
+        script_engine_map_detail::trace_engine_event(true);
+        auto deferred = sl::support::defer([]() STATICLIB_NOEXCEPT {
+            script_engine_map_detail::trace_engine_event(false);
+        });
+        return create_engine(code, std::integral_constant<bool,
+                script_engine_map_detail::has_snapshot_support<Engine>::value>());
+    }
+
+    Engine create_engine(sl::io::span<const char> code, std::false_type) {
+        return Engine(code);
+    }
+
+    Engine create_engine(sl::io::span<const char> code, std::true_type) {
+        auto snapshot = engine_snapshot(code);
+        if (snapshot.size() > 0) {
+            try {
+                return Engine(code, snapshot);
+            } catch (const std::exception&) {
+                // snapshot rejected by the engine, init code is run instead
+                // and the snapshot is created again on the next start
+                std::lock_guard<std::mutex> guard{snapshot_mutex};
+                if (nullptr != snapshot_data) {
+                    script_engine_map_detail::remove_snapshot(std::string(Engine::snapshot_name()));
+                }
+                snapshot_data = nullptr;
+                snapshot_len = 0;
+            }
+        }
+        return Engine(code, script_engine_map_detail::empty_span());
+    }
+
+    // snapshot is created and stored on the first run with the current engine and init code
+    sl::io::span<const char> engine_snapshot(sl::io::span<const char> code) {
+        std::lock_guard<std::mutex> guard{snapshot_mutex};
+        if (!snapshot_checked) {
+            snapshot_checked = true;
+            if (script_engine_map_detail::snapshot_cache_enabled()) {
+                auto name = std::string(Engine::snapshot_name());
+                auto version = std::string(Engine::snapshot_version()) + "-" +
+                        script_engine_map_detail::init_code_digest(code);
+                auto snapshot = script_engine_map_detail::load_snapshot(name, version);
+                if (0 == snapshot.size()) {
+                    try {
+                        auto created = Engine::create_snapshot(code);
+                        script_engine_map_detail::store_snapshot(name, version, created);
+                        snapshot = script_engine_map_detail::load_snapshot(name, version);
+                    } catch (const std::exception&) {
+                        // engine is created without snapshot
+                    }
+                }
+                snapshot_data = snapshot.data();
+                snapshot_len = snapshot.size();
+            }
+        }
+        return sl::io::make_span(snapshot_data, snapshot_len);
+    }
+
+    // lock-free when the engine cached by this thread is still current, its busy
+    // count is raised before the generation is checked, so the engine cannot be
+    // evicted after the check; new engines are taken from the pool or are created
+    // outside of the lock
+    script_engine_map_detail::acquired_engine<Engine> acquire_engine() {
+        thread_local script_engine_map_detail::engine_cache<Engine> cache;
+        if (map_id == cache.map_id) {
+            auto& state = *cache.state;
+            state.busy.fetch_add(1, std::memory_order_seq_cst);
+            if (generation.load(std::memory_order_seq_cst) == cache.generation) {
+                wait_collected(state);
+                return {*cache.engine, state};
+            }
+            state.busy.fetch_sub(1, std::memory_order_release);
+        }
         auto tid = sl::support::to_string_any(std::this_thread::get_id());
-        auto it = engines.find(tid);
-        if (engines.end() == it) {
-            auto code = script_engine_map_detail::load_init_code();
-            auto se = Engine(code);
-            auto pa = engines.insert(std::make_pair(tid, std::move(se)));
-            it = pa.first;
-        }
-        return it->second;
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = engines.find(tid);
+            if (engines.end() == it) {
+                pool.take([this, &tid, &it](Engine&& en) {
+                    it = this->insert_engine(tid, std::move(en));
+                });
+            }
+            if (engines.end() != it) {
+                auto res = cache_engine(cache, it->second);
+                wait_collected(res.state);
+                return res;
+            }
+        }
+        auto se = create_engine();
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = insert_engine(tid, std::move(se));
+        return cache_engine(cache, it->second);
+    }
+
+    // must be called under the lock
+    typename std::map<std::string, script_engine_map_detail::engine_entry<Engine>>::iterator insert_engine(
+            const std::string& tid, Engine&& en) {
+        auto entry = script_engine_map_detail::engine_entry<Engine>(std::move(en));
+        return engines.insert(std::make_pair(tid, std::move(entry))).first;
+    }
+
+    // must be called under the lock
+    script_engine_map_detail::acquired_engine<Engine> cache_engine(
+            script_engine_map_detail::engine_cache<Engine>& cache,
+            script_engine_map_detail::engine_entry<Engine>& entry) {
+        entry.state->busy.fetch_add(1, std::memory_order_seq_cst);
+        cache.map_id = map_id;
+        cache.generation = generation.load(std::memory_order_relaxed);
+        cache.engine = std::addressof(entry.engine);
+        cache.state = entry.state;
+        return {entry.engine, *entry.state};
+    }
+
+    void wait_collected(script_engine_map_detail::engine_state& state) STATICLIB_NOEXCEPT {
+        auto waited = script_engine_map_detail::wait_collected(state);
+        if (waited > 0) {
+            gc_waits.fetch_add(1, std::memory_order_relaxed);
+            gc_wait_micros.fetch_add(waited, std::memory_order_relaxed);
+        }
+    }
+
+    void release_engine(script_engine_map_detail::acquired_engine<Engine>& acquired) STATICLIB_NOEXCEPT {
+        auto& state = acquired.state;
+        if (script_engine_map_detail::has_heap_size<Engine>::value) {
+            try {
+                auto heap = script_engine_map_detail::engine_heap_size(acquired.engine, std::integral_constant<bool,
+                        script_engine_map_detail::has_heap_size<Engine>::value>());
+                auto prev = state.heap_size.exchange(heap, std::memory_order_relaxed);
+                // wraps around when the heap shrinks
+                heap_total.fetch_add(heap - prev, std::memory_order_relaxed);
+            } catch (const std::exception&) {
+                // size is not updated
+            }
+        }
+        state.last_used.store(script_engine_map_detail::now_millis(), std::memory_order_relaxed);
+        state.gc_level.store(0, std::memory_order_relaxed);
+        auto budget = memory_budget.load(std::memory_order_relaxed);
+        if (budget > 0 && heap_total.load(std::memory_order_relaxed) > budget &&
+                support::is_thread_agile<Engine>()) {
+            // engine of this thread is still busy and is not evicted
+            evict_idle(budget);
+        }
+        state.busy.fetch_sub(1, std::memory_order_release);
+    }
+
+    // least recently used first, evicted engines are destroyed outside of the lock
+    // on the calling thread, so only thread agile engines are evicted
+    void evict_idle(uint64_t budget) STATICLIB_NOEXCEPT {
+        auto evicted = std::vector<Engine>();
+        try {
+            std::unique_lock<std::mutex> guard{mutex, std::try_to_lock};
+            if (!guard.owns_lock()) {
+                // checked again after the next call
+                return;
+            }
+            typedef typename std::map<std::string, script_engine_map_detail::engine_entry<Engine>>::iterator iter;
+            auto candidates = std::vector<iter>();
+            for (auto it = engines.begin(); it != engines.end(); ++it) {
+                if (0 == it->second.state->busy.load(std::memory_order_relaxed) &&
+                        !it->second.state->collecting.load(std::memory_order_acquire)) {
+                    candidates.push_back(it);
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const iter& a, const iter& b) {
+                return a->second.state->last_used.load(std::memory_order_relaxed) <
+                        b->second.state->last_used.load(std::memory_order_relaxed);
+            });
+            for (auto it : candidates) {
+                if (heap_total.load(std::memory_order_relaxed) <= budget) {
+                    break;
+                }
+                // owner thread either sees the new generation or is seen as busy here
+                generation.fetch_add(1, std::memory_order_seq_cst);
+                auto& state = *it->second.state;
+                if (0 != state.busy.load(std::memory_order_seq_cst)) {
+                    continue;
+                }
+                heap_total.fetch_sub(state.heap_size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                evicted.emplace_back(std::move(it->second.engine));
+                engines.erase(it);
+                evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+        } catch (const std::exception&) {
+            // eviction is retried after the next call
+        }
+    }
+
+    void run_idle_gc(uint32_t gc_millis, uint32_t full_gc_millis) STATICLIB_NOEXCEPT {
+        auto interval = std::chrono::milliseconds(std::max(10u, gc_millis / 4));
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> guard{gc_mutex};
+                if (gc_cv.wait_for(guard, interval, [this] { return gc_stop; })) {
+                    return;
+                }
+            }
+            while (collect_idle(gc_millis, full_gc_millis)) {
+                std::lock_guard<std::mutex> guard{gc_mutex};
+                if (gc_stop) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // collects one engine, longest idle first, returns false if none is due;
+    // engine is claimed under the lock, so it is not evicted or cleaned while collected
+    bool collect_idle(uint32_t gc_millis, uint32_t full_gc_millis) STATICLIB_NOEXCEPT {
+        Engine* en = nullptr;
+        script_engine_map_detail::engine_state* state = nullptr;
+        bool full = false;
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto now = script_engine_map_detail::now_millis();
+            uint64_t longest_idle = 0;
+            for (auto& pa : engines) {
+                auto& st = *pa.second.state;
+                auto last_used = st.last_used.load(std::memory_order_relaxed);
+                if (0 != st.busy.load(std::memory_order_relaxed) || last_used > now) {
+                    continue;
+                }
+                auto idle = now - last_used;
+                auto level = st.gc_level.load(std::memory_order_relaxed);
+                auto due_full = full_gc_millis > 0 && idle >= full_gc_millis && level < 2;
+                auto due = due_full || (idle >= gc_millis && level < 1);
+                if (due && (nullptr == en || idle > longest_idle)) {
+                    en = std::addressof(pa.second.engine);
+                    state = std::addressof(st);
+                    full = due_full;
+                    longest_idle = idle;
+                }
+            }
+            if (nullptr == en) {
+                return false;
+            }
+            // owner thread either waits for the collection or is seen as busy here
+            state->collecting.store(true, std::memory_order_seq_cst);
+            if (0 != state->busy.load(std::memory_order_seq_cst)) {
+                state->collecting.store(false, std::memory_order_release);
+                return true;
+            }
+        }
+        auto start = script_engine_map_detail::now_micros();
+        try {
+            script_engine_map_detail::engine_collect_garbage(*en, full, std::integral_constant<bool,
+                    script_engine_map_detail::has_collect_garbage<Engine>::value>());
+            if (script_engine_map_detail::has_heap_size<Engine>::value) {
+                auto heap = script_engine_map_detail::engine_heap_size(*en, std::integral_constant<bool,
+                        script_engine_map_detail::has_heap_size<Engine>::value>());
+                auto prev = state->heap_size.exchange(heap, std::memory_order_relaxed);
+                heap_total.fetch_add(heap - prev, std::memory_order_relaxed);
+            }
+        } catch (const std::exception&) {
+            // engine is not collected again until its next call
+        }
+        gc_micros.fetch_add(script_engine_map_detail::now_micros() - start, std::memory_order_relaxed);
+        (full ? gcs_full : gcs_incremental).fetch_add(1, std::memory_order_relaxed);
+        state->gc_level.store(full ? 2 : 1, std::memory_order_relaxed);
+        state->collecting.store(false, std::memory_order_seq_cst);
+        return true;
     }
 
 };
@@ -12,6 +12,32 @@
 extern "C" {
 #endif
 
+// buffer
+
+struct wilton_Buffer;
+typedef struct wilton_Buffer wilton_Buffer;
+
+// takes ownership of the 'wilton_alloc' allocated 'data', reference count
+// of the created buffer is 1; 'data' allocated from an arena is copied
+// outside of it, so the buffer can outlive the arena
+char* wilton_buffer_wrap(
+        char* data,
+        int data_len,
+        wilton_Buffer** buffer_out);
+
+char* wilton_buffer_retain(
+        wilton_Buffer* buffer);
+
+// data is freed when the last reference is released
+char* wilton_buffer_release(
+        wilton_Buffer* buffer);
+
+// data is immutable and stays valid while the reference is held
+char* wilton_buffer_data(
+        wilton_Buffer* buffer,
+        const char** data_out,
+        int* data_len_out);
+
 // dyload
 
 char* wilton_dyload(
@@ -20,11 +46,54 @@ char* wilton_dyload(
         const char* directory,
         int directory_len);
 
+// json
+
+struct wilton_JsonIndex;
+typedef struct wilton_JsonIndex wilton_JsonIndex;
+
+char* wilton_json_index_create(
+        wilton_JsonIndex** index_out);
+
+// validates the JSON input and indexes its structural characters,
+// index memory is reused between builds, input is not copied
+char* wilton_json_index_build(
+        wilton_JsonIndex* index,
+        const char* json,
+        int json_len);
+
+// for every entry 'offsets_out' holds the input offset of a structural character
+// or of a value start, 'next_out' holds the index of the entry after that value;
+// arrays stay valid until the next build or destroy
+char* wilton_json_index_get(
+        wilton_JsonIndex* index,
+        const int** offsets_out,
+        const int** next_out,
+        int* count_out);
+
+char* wilton_json_index_destroy(
+        wilton_JsonIndex* index);
+
 // misc
 
+// buffer must be released with 'wilton_free', with the default "malloc"
+// allocator engine it is returned by 'malloc' as is
 char* wilton_alloc(
         int size_bytes);
 
+// returns null and keeps the buffer on failure, large buffers
+// are resized without copying where the platform allows it
+char* wilton_realloc(
+        char* buffer,
+        int size_bytes);
+
+// allocates outside of the arena opened on the calling thread, for buffers
+// that must outlive it, e.g. error messages, released with 'wilton_free'
+char* wilton_alloc_detached(
+        int size_bytes);
+
+// passing a buffer not allocated with 'wilton_alloc' is undefined behaviour;
+// with 'allocator.tracking' enabled at init such buffers are leaked instead,
+// counted in 'get_alloc_stats' and listed in 'get_alloc_tracking' output
 void wilton_free(
         char* buffer);
 
@@ -32,6 +101,14 @@ char* wilton_config(
         char** conf_json_out,
         int* conf_json_len_out);
 
+// returns the config value at dot-separated 'path' (e.g. "requireJs.baseUrl")
+// as JSON, array elements are addressed by index, missing values are 'null'
+char* wilton_config_get(
+        const char* path,
+        int path_len,
+        char** value_json_out,
+        int* value_json_len_out);
+
 char* wilton_clean_tls(
         const char* thread_id,
         int thread_id_len);
@@ -43,6 +120,83 @@ char* wilton_register_tls_cleaner(
                 const char* thread_id,
                 int thread_id_len));
 
+// engine maps report their statistics as a JSON object allocated with 'wilton_alloc',
+// reports of all the registered maps are returned by 'get_engine_stats' call
+char* wilton_register_engine_stats(
+        void* stats_ctx,
+        char* (*stats_cb)(
+                void* stats_ctx,
+                char** stats_json_out,
+                int* stats_json_len_out));
+
+// waits for the reports in progress, map can be destroyed after it returns
+char* wilton_unregister_engine_stats(
+        void* stats_ctx);
+
+// arena
+
+struct wilton_Arena;
+typedef struct wilton_Arena wilton_Arena;
+
+// all the 'wilton_alloc' allocations on the calling thread are made from
+// the arena until it is closed, 'wilton_free' on them does nothing;
+// arenas can be nested and must be closed on the same thread in reverse order;
+// error messages returned by wilton functions are not allocated from arenas
+char* wilton_arena_open(
+        int chunk_size_bytes,
+        wilton_Arena** arena_out);
+
+// releases all the memory allocated from the arena, buffers allocated
+// from it must not be used or passed to 'wilton_free' after that
+char* wilton_arena_close(
+        wilton_Arena* arena);
+
+// snapshot
+
+// engine snapshot cache in 'snapshotCache.directory', entry is returned only
+// if it was stored with the same version and passes the checksum, otherwise
+// 'data_out' is set to null; data is memory-mapped and stays valid until exit
+char* wilton_snapshot_load(
+        const char* name,
+        int name_len,
+        const char* version,
+        int version_len,
+        const char** data_out,
+        int* data_len_out);
+
+// replaces the entry atomically, does nothing when the cache is disabled
+char* wilton_snapshot_store(
+        const char* name,
+        int name_len,
+        const char* version,
+        int version_len,
+        const char* data,
+        int data_len);
+
+// removes the entry of all versions, used when the engine rejects the stored snapshot;
+// data returned by 'wilton_snapshot_load' before stays valid until exit
+char* wilton_snapshot_remove(
+        const char* name,
+        int name_len);
+
+char* wilton_snapshot_enabled(
+        int* enabled_out);
+
+// trace
+
+// does nothing when tracing is disabled
+char* wilton_trace_begin(
+        const char* category,
+        int category_len,
+        const char* name,
+        int name_len);
+
+char* wilton_trace_end(
+        const char* category,
+        int category_len,
+        const char* name,
+        int name_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,7 +13,30 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-    
+
+enum wiltoncall_error_code {
+    WILTONCALL_OK = 0,
+    WILTONCALL_ERROR_INVALID_PARAMETER = 1,
+    WILTONCALL_ERROR_UNKNOWN_NAME = 2,
+    WILTONCALL_ERROR_REMOVED_NAME = 3,
+    WILTONCALL_ERROR_CALLBACK = 4,
+    WILTONCALL_ERROR_INVALID_RESULT = 5,
+    WILTONCALL_ERROR_PAYLOAD_FORMAT = 6
+};
+
+// calls registered without a format accept and produce JSON,
+// payloads are transcoded only when caller and call formats differ
+enum wiltoncall_payload_format {
+    WILTONCALL_FORMAT_JSON = 0,
+    WILTONCALL_FORMAT_CBOR = 1
+};
+
+struct wilton_CallHandle;
+typedef struct wilton_CallHandle wilton_CallHandle;
+
+struct wilton_CallFuture;
+typedef struct wilton_CallFuture wilton_CallFuture;
+
 char* wiltoncall(
         const char* call_name,
         int call_name_len,
@@ -22,6 +45,75 @@ char* wiltoncall(
         char** json_out,
         int* json_out_len);
 
+// 'data_in' is encoded with 'format_in', result is returned encoded with 'format_out'
+char* wiltoncall_format(
+        const char* call_name,
+        int call_name_len,
+        int format_in,
+        const char* data_in,
+        int data_in_len,
+        int format_out,
+        char** data_out,
+        int* data_out_len);
+
+// results of all items are returned in a single buffer, item 'i' occupies
+// bytes [offsets_out[i], offsets_out[i + 1]), 'offsets_out' must have
+// 'items_count + 1' elements, for failed items 'errors_out[i]' is set to 1
+// and the error message is returned in place of the item result
+char* wiltoncall_batch(
+        const char** call_names,
+        const int* call_names_lens,
+        const char** jsons_in,
+        const int* jsons_in_lens,
+        int items_count,
+        char** batch_out,
+        int* batch_out_len,
+        int* offsets_out,
+        int* errors_out);
+
+// call is run on the pool configured with 'asyncPool.threadsCount',
+// result is passed either to 'cb' (that takes ownership of 'err' and 'json_out')
+// or to the future, when neither is specified the result is discarded
+char* wiltoncall_async(
+        const char* call_name,
+        int call_name_len,
+        const char* json_in,
+        int json_in_len,
+        void* cb_ctx,
+        void (*cb)(
+                void* cb_ctx,
+                char* err,
+                char* json_out,
+                int json_out_len),
+        wilton_CallFuture** future_out);
+
+// negative 'timeout_millis' waits until completion, zero only polls
+char* wiltoncall_future_wait(
+        wilton_CallFuture* future,
+        int timeout_millis,
+        int* ready_out);
+
+// returns the error of the completed call
+char* wiltoncall_future_get(
+        wilton_CallFuture* future,
+        char** json_out,
+        int* json_out_len);
+
+char* wiltoncall_future_destroy(
+        wilton_CallFuture* future);
+
+// result is written to 'out_buf' and 'json_out_len' is set to its full length
+// (zero for empty result), when the length exceeds 'out_buf_cap' the buffer
+// contents are unspecified and the call must be repeated with a larger buffer
+char* wiltoncall_into(
+        const char* call_name,
+        int call_name_len,
+        const char* json_in,
+        int json_in_len,
+        char* out_buf,
+        int out_buf_cap,
+        int* json_out_len);
+
 char* wiltoncall_register(
         const char* call_name,
         int call_name_len,
@@ -33,10 +125,102 @@ char* wiltoncall_register(
                 char** json_out,
                 int* json_out_len));
 
+// callback accepts and produces payloads encoded with 'payload_format'
+char* wiltoncall_register_format(
+        const char* call_name,
+        int call_name_len,
+        void* call_ctx,
+        char* (*call_cb)(
+                void* call_ctx,
+                const char* data_in,
+                int data_in_len,
+                char** data_out,
+                int* data_out_len),
+        int payload_format);
+
+// results are cached by input payload, for calls whose
+// output depends only on input, zero 'ttl_millis' means no expiration
+char* wiltoncall_register_cacheable(
+        const char* call_name,
+        int call_name_len,
+        void* call_ctx,
+        char* (*call_cb)(
+                void* call_ctx,
+                const char* json_in,
+                int json_in_len,
+                char** json_out,
+                int* json_out_len),
+        int ttl_millis,
+        int max_entries);
+
+// 'into_cb' writes the result to 'out_buf' and sets 'json_out_len' to its full length,
+// optional 'call_cb' is used by the allocating API, without it 'into_cb' is called
+// again with a larger buffer when the result does not fit into a small one
+char* wiltoncall_register_into(
+        const char* call_name,
+        int call_name_len,
+        void* call_ctx,
+        char* (*call_cb)(
+                void* call_ctx,
+                const char* json_in,
+                int json_in_len,
+                char** json_out,
+                int* json_out_len),
+        char* (*into_cb)(
+                void* call_ctx,
+                const char* json_in,
+                int json_in_len,
+                char* out_buf,
+                int out_buf_cap,
+                int* json_out_len));
+
 char* wiltoncall_remove(
         const char* call_name,
         int call_name_len);
 
+// returns error code and does not allocate on errors,
+// error details are kept per thread until the next call
+int wiltoncall_coded(
+        const char* call_name,
+        int call_name_len,
+        const char* json_in,
+        int json_in_len,
+        char** json_out,
+        int* json_out_len);
+
+// returns the code of the last 'wiltoncall_coded' error on this thread,
+// its message is written to 'buf' truncated to 'buf_len' bytes
+int wiltoncall_last_error(
+        char* buf,
+        int buf_len);
+
+// handle stays valid after 'wiltoncall_remove' of its name,
+// invocations through it fail after that
+char* wiltoncall_resolve(
+        const char* call_name,
+        int call_name_len,
+        wilton_CallHandle** handle_out);
+
+char* wiltoncall_invoke(
+        wilton_CallHandle* handle,
+        const char* json_in,
+        int json_in_len,
+        char** json_out,
+        int* json_out_len);
+
+char* wiltoncall_release(
+        wilton_CallHandle* handle);
+
+// converts a payload between formats, for the modules
+// that produce or consume binary payloads
+char* wiltoncall_transcode(
+        int format_in,
+        const char* data_in,
+        int data_in_len,
+        int format_out,
+        char** data_out,
+        int* data_out_len);
+
 char* wiltoncall_init(
         const char* config_json,
         int config_json_len);
@@ -0,0 +1,358 @@
+/*
+ * File:   alloc_tracking.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 9:55 PM
+ */
+
+#include "alloc/alloc_tracking.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace alloc {
+
+namespace { // anonymous
+
+const size_t max_origins = 1 << 12;
+const uint16_t origin_overflow = 2;
+const size_t live_shards_count = 64;
+const size_t max_unknown = 128;
+
+std::atomic<bool> tracking_flag{false};
+
+thread_local uint16_t current_origin = origin_none;
+
+struct origin_stats {
+    const std::string name;
+    std::atomic<int64_t> live_bytes;
+    std::atomic<int64_t> live_count;
+    std::atomic<uint64_t> allocs;
+
+    origin_stats(const std::string& name) :
+    name(name.data(), name.length()),
+    live_bytes(0),
+    live_count(0),
+    allocs(0) { }
+};
+
+struct live_record {
+    uint16_t origin;
+    uint64_t size;
+    uint64_t allocated_at;
+};
+
+struct unknown_record {
+    const char* buffer;
+    const char* fun;
+};
+
+uint64_t now_millis() STATICLIB_NOEXCEPT {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+/**
+ * Live gauges per origin and the set of live tracked buffers,
+ * records are sharded by buffer address
+ */
+class tracker {
+    struct live_shard {
+        std::mutex mutex;
+        std::unordered_map<const char*, live_record> records;
+    };
+
+    std::array<std::atomic<origin_stats*>, max_origins> origins;
+    std::mutex names_mutex;
+    std::unordered_map<std::string, uint16_t> names;
+    uint16_t next_origin = 1;
+    std::array<live_shard, live_shards_count> live;
+    std::mutex unknown_mutex;
+    std::vector<unknown_record> unknown;
+
+public:
+    tracker() {
+        for (auto& ori : origins) {
+            ori.store(nullptr, std::memory_order_relaxed);
+        }
+        // must match 'origin_none' and 'origin_overflow'
+        add_origin("<none>");
+        add_origin("<overflow>");
+    }
+
+    tracker(const tracker&) = delete;
+
+    tracker& operator=(const tracker&) = delete;
+
+    uint16_t origin_for(const std::string& call_name) {
+        std::lock_guard<std::mutex> guard{names_mutex};
+        auto it = names.find(call_name);
+        if (names.end() != it) {
+            return it->second;
+        }
+        if (next_origin >= max_origins) {
+            return origin_overflow;
+        }
+        return add_origin(call_name);
+    }
+
+    void on_alloc(const char* buffer, uint64_t size, uint16_t origin) STATICLIB_NOEXCEPT {
+        auto os = origins[origin].load(std::memory_order_acquire);
+        os->live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        os->live_count.fetch_add(1, std::memory_order_relaxed);
+        os->allocs.fetch_add(1, std::memory_order_relaxed);
+        auto& sh = shard_of(buffer);
+        try {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            sh.records[buffer] = live_record{origin, size, now_millis()};
+        } catch (...) {
+            // counted in gauges only
+        }
+    }
+
+    bool on_free(const char* buffer) STATICLIB_NOEXCEPT {
+        auto& sh = shard_of(buffer);
+        auto rec = live_record();
+        {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            auto it = sh.records.find(buffer);
+            if (sh.records.end() == it) {
+                return false;
+            }
+            rec = it->second;
+            sh.records.erase(it);
+        }
+        auto os = origins[rec.origin].load(std::memory_order_acquire);
+        os->live_bytes.fetch_sub(static_cast<int64_t>(rec.size), std::memory_order_relaxed);
+        os->live_count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void on_resize(const char* buffer, const char* resized, uint64_t size) STATICLIB_NOEXCEPT {
+        auto rec = live_record();
+        {
+            auto& sh = shard_of(buffer);
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            auto it = sh.records.find(buffer);
+            if (sh.records.end() == it) {
+                return;
+            }
+            rec = it->second;
+            sh.records.erase(it);
+        }
+        auto os = origins[rec.origin].load(std::memory_order_acquire);
+        os->live_bytes.fetch_add(static_cast<int64_t>(size) - static_cast<int64_t>(rec.size),
+                std::memory_order_relaxed);
+        rec.size = size;
+        auto& sh = shard_of(resized);
+        try {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            sh.records[resized] = rec;
+        } catch (...) {
+            // counted in gauges only
+        }
+    }
+
+    bool find(const char* buffer, uint64_t& size_out) STATICLIB_NOEXCEPT {
+        auto& sh = shard_of(buffer);
+        std::lock_guard<std::mutex> guard{sh.mutex};
+        auto it = sh.records.find(buffer);
+        if (sh.records.end() == it) {
+            return false;
+        }
+        size_out = it->second.size;
+        return true;
+    }
+
+    void on_unknown(const char* buffer, const char* fun) STATICLIB_NOEXCEPT {
+        std::lock_guard<std::mutex> guard{unknown_mutex};
+        if (unknown.size() < max_unknown) {
+            try {
+                unknown.push_back(unknown_record{buffer, fun});
+            } catch (...) {
+                // counted in alloc stats only
+            }
+        }
+    }
+
+    sl::json::value report(size_t limit) {
+        auto origins_json = std::vector<sl::json::value>();
+        // zero origin is not used
+        for (size_t i = 1; i < origins.size(); i++) {
+            auto os = origins[i].load(std::memory_order_acquire);
+            if (nullptr == os) break;
+            auto allocs = os->allocs.load(std::memory_order_relaxed);
+            if (0 == allocs) continue;
+            origins_json.emplace_back(sl::json::value({
+                { "name", os->name },
+                { "liveBytes", static_cast<int64_t>(os->live_bytes.load(std::memory_order_relaxed)) },
+                { "liveCount", static_cast<int64_t>(os->live_count.load(std::memory_order_relaxed)) },
+                { "allocs", static_cast<int64_t>(allocs) }
+            }));
+        }
+        auto records = std::vector<live_record>();
+        for (auto& sh : live) {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            for (auto& pa : sh.records) {
+                records.push_back(pa.second);
+            }
+        }
+        auto count = std::min(limit, records.size());
+        std::partial_sort(records.begin(), records.begin() + count, records.end(),
+                [](const live_record& a, const live_record& b) {
+                    return a.allocated_at < b.allocated_at;
+                });
+        auto now = now_millis();
+        auto outstanding = std::vector<sl::json::value>();
+        for (size_t i = 0; i < count; i++) {
+            auto& rec = records[i];
+            outstanding.emplace_back(sl::json::value({
+                { "origin", origins[rec.origin].load(std::memory_order_acquire)->name },
+                { "size", static_cast<int64_t>(rec.size) },
+                { "ageMillis", static_cast<int64_t>(now - rec.allocated_at) }
+            }));
+        }
+        auto unknown_json = std::vector<sl::json::value>();
+        {
+            std::lock_guard<std::mutex> guard{unknown_mutex};
+            for (size_t i = 0; i < unknown.size() && i < limit; i++) {
+                unknown_json.emplace_back(sl::json::value({
+                    { "address", address_string(unknown[i].buffer) },
+                    { "call", unknown[i].fun }
+                }));
+            }
+        }
+        return {
+            { "enabled", tracking_flag.load() },
+            { "origins", std::move(origins_json) },
+            { "outstandingCount", static_cast<int64_t>(records.size()) },
+            { "outstanding", std::move(outstanding) },
+            { "unknown", std::move(unknown_json) }
+        };
+    }
+
+    void print_report() STATICLIB_NOEXCEPT {
+        bool header_printed = false;
+        // zero origin is not used
+        for (size_t i = 1; i < origins.size(); i++) {
+            auto os = origins[i].load(std::memory_order_acquire);
+            if (nullptr == os) break;
+            auto count = os->live_count.load(std::memory_order_relaxed);
+            if (count <= 0) continue;
+            if (!header_printed) {
+                std::fprintf(stderr, "wilton_alloc: buffers not freed at shutdown:\n");
+                header_printed = true;
+            }
+            std::fprintf(stderr, "  [%s]: count: [%lld], bytes: [%lld]\n", os->name.c_str(),
+                    static_cast<long long> (count),
+                    static_cast<long long> (os->live_bytes.load(std::memory_order_relaxed)));
+        }
+    }
+
+private:
+    // must be called under names_mutex or from constructor
+    uint16_t add_origin(const std::string& call_name) {
+        auto id = next_origin;
+        auto os = new origin_stats(call_name);
+        try {
+            names.insert(std::make_pair(os->name, id));
+        } catch (...) {
+            delete os;
+            throw;
+        }
+        origins[id].store(os, std::memory_order_release);
+        next_origin += 1;
+        return id;
+    }
+
+    static std::string address_string(const char* buffer) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%p", static_cast<const void*>(buffer));
+        return std::string(buf);
+    }
+
+    live_shard& shard_of(const char* buffer) STATICLIB_NOEXCEPT {
+        auto addr = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(buffer));
+        auto idx = ((addr >> 4) * 0x9E3779B97F4A7C15ULL) >> 58;
+        return live[idx % live_shards_count];
+    }
+};
+
+// never destroyed, tracked buffers can be freed
+// by other static destructors after the report
+tracker& shared_tracker() {
+    static tracker* tr = new tracker();
+    return *tr;
+}
+
+class shutdown_reporter {
+public:
+    ~shutdown_reporter() STATICLIB_NOEXCEPT {
+        shared_tracker().print_report();
+    }
+};
+
+} // namespace
+
+bool tracking_enabled() STATICLIB_NOEXCEPT {
+    return tracking_flag.load(std::memory_order_relaxed);
+}
+
+void set_tracking_enabled(bool enabled) STATICLIB_NOEXCEPT {
+    if (enabled) {
+        shared_tracker();
+        static shutdown_reporter reporter;
+        (void) reporter;
+    }
+    tracking_flag.store(enabled, std::memory_order_relaxed);
+}
+
+uint16_t origin_for(const std::string& call_name) STATICLIB_NOEXCEPT {
+    try {
+        return shared_tracker().origin_for(call_name);
+    } catch (...) {
+        return origin_overflow;
+    }
+}
+
+uint16_t set_current_origin(uint16_t origin) STATICLIB_NOEXCEPT {
+    auto prev = current_origin;
+    current_origin = origin;
+    return prev;
+}
+
+void track_alloc(const char* buffer, uint64_t size, uint16_t origin) STATICLIB_NOEXCEPT {
+    shared_tracker().on_alloc(buffer, size, 0 != origin ? origin : current_origin);
+}
+
+bool track_free(const char* buffer) STATICLIB_NOEXCEPT {
+    return shared_tracker().on_free(buffer);
+}
+
+void track_resize(const char* buffer, const char* resized, uint64_t size) STATICLIB_NOEXCEPT {
+    shared_tracker().on_resize(buffer, resized, size);
+}
+
+bool find_tracked(const char* buffer, uint64_t& size_out) STATICLIB_NOEXCEPT {
+    return shared_tracker().find(buffer, size_out);
+}
+
+void track_unknown(const char* buffer, const char* fun) STATICLIB_NOEXCEPT {
+    shared_tracker().on_unknown(buffer, fun);
+}
+
+sl::json::value tracking_report(size_t limit) {
+    return shared_tracker().report(limit);
+}
+
+} // namespace
+}
@@ -0,0 +1,85 @@
+/*
+ * File:   alloc_tracking.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 9:40 PM
+ */
+
+#ifndef WILTON_ALLOC_ALLOC_TRACKING_HPP
+#define WILTON_ALLOC_ALLOC_TRACKING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+#include "alloc/allocator.hpp"
+
+namespace wilton {
+namespace alloc {
+
+// origin of the buffers allocated outside of any call
+const uint16_t origin_none = 1;
+
+bool tracking_enabled() STATICLIB_NOEXCEPT;
+
+void set_tracking_enabled(bool enabled) STATICLIB_NOEXCEPT;
+
+// returns a shared overflow origin when too many names are tracked
+uint16_t origin_for(const std::string& call_name) STATICLIB_NOEXCEPT;
+
+// returns the previous origin of this thread
+uint16_t set_current_origin(uint16_t origin) STATICLIB_NOEXCEPT;
+
+// zero origin means the current origin of this thread
+void track_alloc(const char* buffer, uint64_t size, uint16_t origin) STATICLIB_NOEXCEPT;
+
+// returns false if the buffer is not tracked
+bool track_free(const char* buffer) STATICLIB_NOEXCEPT;
+
+// moves the record of a tracked buffer to its new address and size
+void track_resize(const char* buffer, const char* resized, uint64_t size) STATICLIB_NOEXCEPT;
+
+// returns false if the buffer is not tracked
+bool find_tracked(const char* buffer, uint64_t& size_out) STATICLIB_NOEXCEPT;
+
+// remembers a buffer that was not allocated with 'wilton_alloc'
+void track_unknown(const char* buffer, const char* fun) STATICLIB_NOEXCEPT;
+
+// live gauges per origin, up to 'limit' oldest outstanding
+// buffers and up to 'limit' unknown buffers passed to 'wilton_free'
+sl::json::value tracking_report(size_t limit);
+
+/**
+ * Tags the allocations made on this thread with the specified origin,
+ * zero origin leaves the current one unchanged
+ */
+class origin_scope {
+    const uint16_t origin;
+    uint16_t prev = 0;
+
+public:
+    origin_scope(uint16_t origin) :
+    origin(origin) {
+        if (0 != origin) {
+            prev = set_current_origin(origin);
+        }
+    }
+
+    origin_scope(const origin_scope&) = delete;
+
+    origin_scope& operator=(const origin_scope&) = delete;
+
+    ~origin_scope() STATICLIB_NOEXCEPT {
+        if (0 != origin) {
+            set_current_origin(prev);
+        }
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_ALLOC_ALLOC_TRACKING_HPP */
@@ -0,0 +1,932 @@
+/*
+ * File:   allocator.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 6:55 PM
+ */
+
+#include "alloc/allocator.hpp"
+#include "alloc/alloc_tracking.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "staticlib/support.hpp"
+
+#ifdef STATICLIB_WINDOWS
+#include <malloc.h>
+#endif // STATICLIB_WINDOWS
+#ifdef STATICLIB_LINUX
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // STATICLIB_LINUX
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace alloc {
+
+namespace { // anonymous
+
+// pool size classes from 32 bytes to 64 KB
+const size_t classes_count = 12;
+const size_t min_class_size = 32;
+// slabs are aligned to their size, slab of a block is found by its address
+const size_t slab_size = 1 << 18;
+// at most half of the entries are used, 2 GB of slabs
+const size_t slab_entries_count = 1 << 14;
+const size_t max_mmap_blocks = 1024;
+
+std::atomic<bool> pool_enabled{false};
+std::atomic<size_t> mmap_threshold{1 << 24};
+std::atomic<bool> huge_pages_enabled{false};
+
+size_t class_size(size_t idx) STATICLIB_NOEXCEPT {
+    return min_class_size << idx;
+}
+
+// returns 'classes_count' for large blocks
+size_t class_index(size_t size) STATICLIB_NOEXCEPT {
+    size_t idx = 0;
+    while (idx < classes_count && class_size(idx) < size) {
+        idx += 1;
+    }
+    return idx;
+}
+
+// number of blocks moved between thread cache and global lists at once
+size_t batch_size(size_t idx) STATICLIB_NOEXCEPT {
+    return std::max(static_cast<size_t>(2), std::min(static_cast<size_t>(64), (64 * 1024) / class_size(idx)));
+}
+
+struct free_node {
+    free_node* next;
+};
+
+struct counters {
+    std::array<std::atomic<uint64_t>, classes_count> allocs;
+    std::array<std::atomic<uint64_t>, classes_count> hits;
+    std::atomic<uint64_t> large_allocs;
+    std::atomic<uint64_t> arena_allocs;
+    std::atomic<uint64_t> mmap_allocs;
+    std::atomic<uint64_t> mremaps;
+    std::atomic<uint64_t> unknown_frees;
+    std::atomic<int64_t> live_bytes;
+
+    counters() :
+    large_allocs(0),
+    arena_allocs(0),
+    mmap_allocs(0),
+    mremaps(0),
+    unknown_frees(0),
+    live_bytes(0) {
+        for (size_t i = 0; i < classes_count; i++) {
+            allocs[i].store(0, std::memory_order_relaxed);
+            hits[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add_to(counters& other) const STATICLIB_NOEXCEPT {
+        for (size_t i = 0; i < classes_count; i++) {
+            other.allocs[i].fetch_add(allocs[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.hits[i].fetch_add(hits[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        other.large_allocs.fetch_add(large_allocs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.arena_allocs.fetch_add(arena_allocs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.mmap_allocs.fetch_add(mmap_allocs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.mremaps.fetch_add(mremaps.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.unknown_frees.fetch_add(unknown_frees.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.live_bytes.fetch_add(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+};
+
+char* allocate_slab() STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_WINDOWS
+    return static_cast<char*>(_aligned_malloc(slab_size, slab_size));
+#else // !STATICLIB_WINDOWS
+    void* res = nullptr;
+    if (0 != posix_memalign(std::addressof(res), slab_size, slab_size)) {
+        return nullptr;
+    }
+    return static_cast<char*>(res);
+#endif // STATICLIB_WINDOWS
+}
+
+void free_slab(char* slab) STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_WINDOWS
+    _aligned_free(slab);
+#else // !STATICLIB_WINDOWS
+    std::free(slab);
+#endif // STATICLIB_WINDOWS
+}
+
+/**
+ * Open addressing set of the slab addresses, every entry also holds
+ * the size class of the slab in its low bits; entries are never removed,
+ * so lookups do not take locks
+ */
+class slab_table {
+    std::array<std::atomic<uintptr_t>, slab_entries_count> entries;
+    std::atomic<size_t> count;
+
+public:
+    slab_table() :
+    count(0) {
+        for (auto& en : entries) {
+            en.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    slab_table(const slab_table&) = delete;
+
+    slab_table& operator=(const slab_table&) = delete;
+
+    bool insert(const char* slab, size_t idx) STATICLIB_NOEXCEPT {
+        if (count.fetch_add(1, std::memory_order_relaxed) >= slab_entries_count / 2) {
+            count.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto addr = reinterpret_cast<uintptr_t>(slab);
+        auto pos = position(addr);
+        for (;;) {
+            uintptr_t the_zero = 0;
+            if (entries[pos].compare_exchange_strong(the_zero, addr | idx, std::memory_order_release)) {
+                return true;
+            }
+            pos = (pos + 1) % slab_entries_count;
+        }
+    }
+
+    // returns 'classes_count' for the blocks outside of the slabs
+    size_t find(const char* block) const STATICLIB_NOEXCEPT {
+        if (0 == count.load(std::memory_order_relaxed)) {
+            return classes_count;
+        }
+        auto addr = reinterpret_cast<uintptr_t>(block) & ~(static_cast<uintptr_t>(slab_size) - 1);
+        auto pos = position(addr);
+        for (;;) {
+            auto en = entries[pos].load(std::memory_order_acquire);
+            if (0 == en) {
+                return classes_count;
+            }
+            if (addr == (en & ~(static_cast<uintptr_t>(slab_size) - 1))) {
+                return static_cast<size_t>(en & (slab_size - 1));
+            }
+            pos = (pos + 1) % slab_entries_count;
+        }
+    }
+
+private:
+    static size_t position(uintptr_t addr) STATICLIB_NOEXCEPT {
+        auto num = static_cast<uint64_t>(addr / slab_size);
+        return static_cast<size_t>((num * 0x9E3779B97F4A7C15ULL) >> 50) % slab_entries_count;
+    }
+};
+
+class thread_cache;
+
+/**
+ * Blocks shared between threads, blocks are carved from slabs
+ * that are kept for the lifetime of the process
+ */
+class global_pool {
+    struct class_list {
+        std::mutex mutex;
+        free_node* head = nullptr;
+    };
+
+    std::array<class_list, classes_count> lists;
+    slab_table slabs;
+    std::atomic<uint64_t> pooled_bytes;
+    std::mutex caches_mutex;
+    std::unordered_set<thread_cache*> caches;
+    // counters of exited threads and of threads without cache
+    counters retired;
+
+public:
+    global_pool() :
+    pooled_bytes(0) { }
+
+    global_pool(const global_pool&) = delete;
+
+    global_pool& operator=(const global_pool&) = delete;
+
+    // returns the number of blocks taken
+    size_t take(size_t idx, size_t count, free_node*& head_out) STATICLIB_NOEXCEPT {
+        auto& li = lists[idx];
+        free_node* head = nullptr;
+        size_t taken = 0;
+        {
+            std::lock_guard<std::mutex> guard{li.mutex};
+            while (taken < count && nullptr != li.head) {
+                auto node = li.head;
+                li.head = node->next;
+                node->next = head;
+                head = node;
+                taken += 1;
+            }
+        }
+        if (0 == taken) {
+            taken = carve(idx, count, head);
+        }
+        head_out = head;
+        return taken;
+    }
+
+    void give(size_t idx, free_node* head, free_node* tail) STATICLIB_NOEXCEPT {
+        auto& li = lists[idx];
+        std::lock_guard<std::mutex> guard{li.mutex};
+        tail->next = li.head;
+        li.head = head;
+    }
+
+    // returns 'classes_count' for the blocks not allocated from the pool
+    size_t find_class(const char* block) const STATICLIB_NOEXCEPT {
+        return slabs.find(block);
+    }
+
+    void register_cache(thread_cache* tc) {
+        std::lock_guard<std::mutex> guard{caches_mutex};
+        caches.insert(tc);
+    }
+
+    void unregister_cache(thread_cache* tc, const counters& cs) STATICLIB_NOEXCEPT {
+        std::lock_guard<std::mutex> guard{caches_mutex};
+        caches.erase(tc);
+        cs.add_to(retired);
+    }
+
+    counters& retired_counters() STATICLIB_NOEXCEPT {
+        return retired;
+    }
+
+    sl::json::value stats();
+
+private:
+    size_t carve(size_t idx, size_t count, free_node*& head) STATICLIB_NOEXCEPT {
+        auto bsize = class_size(idx);
+        auto slab = allocate_slab();
+        if (nullptr == slab) {
+            return 0;
+        }
+        if (!slabs.insert(slab, idx)) {
+            // slab cannot be found on free, large blocks are used instead
+            free_slab(slab);
+            return 0;
+        }
+        pooled_bytes.fetch_add(slab_size, std::memory_order_relaxed);
+        auto blocks = slab_size / bsize;
+        // first 'count' blocks go to the caller, the rest to the global list
+        size_t taken = 0;
+        free_node* rest_head = nullptr;
+        free_node* rest_tail = nullptr;
+        for (size_t i = 0; i < blocks; i++) {
+            auto node = reinterpret_cast<free_node*>(slab + i * bsize);
+            if (taken < count) {
+                node->next = head;
+                head = node;
+                taken += 1;
+            } else {
+                node->next = rest_head;
+                rest_head = node;
+                if (nullptr == rest_tail) {
+                    rest_tail = node;
+                }
+            }
+        }
+        if (nullptr != rest_head) {
+            give(idx, rest_head, rest_tail);
+        }
+        return taken;
+    }
+};
+
+std::shared_ptr<global_pool> shared_pool() {
+    static auto pool = std::make_shared<global_pool>();
+    return pool;
+}
+
+/**
+ * Address ranges of the arena chunks, looked up only while
+ * at least one arena chunk is allocated
+ */
+class chunk_table {
+    std::mutex mutex;
+    // chunk address to its end
+    std::map<uintptr_t, uintptr_t> chunks;
+    std::atomic<size_t> count;
+
+public:
+    chunk_table() :
+    count(0) { }
+
+    chunk_table(const chunk_table&) = delete;
+
+    chunk_table& operator=(const chunk_table&) = delete;
+
+    bool insert(const char* chunk, size_t size) STATICLIB_NOEXCEPT {
+        auto addr = reinterpret_cast<uintptr_t>(chunk);
+        try {
+            std::lock_guard<std::mutex> guard{mutex};
+            chunks[addr] = addr + size;
+        } catch (...) {
+            return false;
+        }
+        count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void erase(const char* chunk) STATICLIB_NOEXCEPT {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (chunks.erase(reinterpret_cast<uintptr_t>(chunk)) > 0) {
+            count.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // returns the number of chunk bytes starting at the block, zero outside of the chunks
+    size_t find(const char* block) STATICLIB_NOEXCEPT {
+        if (0 == count.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        auto addr = reinterpret_cast<uintptr_t>(block);
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = chunks.upper_bound(addr);
+        if (chunks.begin() == it) {
+            return 0;
+        }
+        --it;
+        return addr < it->second ? static_cast<size_t>(it->second - addr) : 0;
+    }
+};
+
+// never destroyed, arenas and buffers can be
+// released by other static destructors
+chunk_table& shared_chunks() {
+    static chunk_table* table = new chunk_table();
+    return *table;
+}
+
+thread_local arena* current_arena_ptr = nullptr;
+
+// set when the thread cache is destroyed on thread exit,
+// allocations after that go directly to the global pool
+thread_local bool cache_destroyed = false;
+
+class thread_cache {
+    struct class_cache {
+        free_node* head = nullptr;
+        size_t count = 0;
+    };
+
+    std::shared_ptr<global_pool> pool;
+    std::array<class_cache, classes_count> classes;
+
+public:
+    counters stats;
+
+    thread_cache() :
+    pool(shared_pool()) {
+        pool->register_cache(this);
+    }
+
+    thread_cache(const thread_cache&) = delete;
+
+    thread_cache& operator=(const thread_cache&) = delete;
+
+    ~thread_cache() STATICLIB_NOEXCEPT {
+        for (size_t i = 0; i < classes_count; i++) {
+            flush(i, classes[i].count);
+        }
+        pool->unregister_cache(this, stats);
+        cache_destroyed = true;
+    }
+
+    char* take(size_t idx) STATICLIB_NOEXCEPT {
+        auto& cc = classes[idx];
+        stats.allocs[idx].fetch_add(1, std::memory_order_relaxed);
+        if (nullptr != cc.head) {
+            stats.hits[idx].fetch_add(1, std::memory_order_relaxed);
+        } else {
+            cc.count = pool->take(idx, batch_size(idx), cc.head);
+            if (0 == cc.count) {
+                return nullptr;
+            }
+        }
+        auto node = cc.head;
+        cc.head = node->next;
+        cc.count -= 1;
+        return reinterpret_cast<char*>(node);
+    }
+
+    void give(size_t idx, char* block) STATICLIB_NOEXCEPT {
+        auto& cc = classes[idx];
+        auto node = reinterpret_cast<free_node*>(block);
+        node->next = cc.head;
+        cc.head = node;
+        cc.count += 1;
+        if (cc.count > 2 * batch_size(idx)) {
+            flush(idx, batch_size(idx));
+        }
+    }
+
+private:
+    void flush(size_t idx, size_t count) STATICLIB_NOEXCEPT {
+        auto& cc = classes[idx];
+        if (0 == count || nullptr == cc.head) {
+            return;
+        }
+        auto head = cc.head;
+        auto tail = head;
+        size_t moved = 1;
+        while (moved < count && nullptr != tail->next) {
+            tail = tail->next;
+            moved += 1;
+        }
+        cc.head = tail->next;
+        cc.count -= moved;
+        pool->give(idx, head, tail);
+    }
+};
+
+thread_cache* current_cache() STATICLIB_NOEXCEPT {
+    if (cache_destroyed) {
+        return nullptr;
+    }
+    try {
+        thread_local thread_cache cache;
+        return std::addressof(cache);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+sl::json::value global_pool::stats() {
+    counters total;
+    {
+        std::lock_guard<std::mutex> guard{caches_mutex};
+        retired.add_to(total);
+        for (auto tc : caches) {
+            tc->stats.add_to(total);
+        }
+    }
+    auto classes_json = std::vector<sl::json::value>();
+    for (size_t i = 0; i < classes_count; i++) {
+        auto allocs = total.allocs[i].load(std::memory_order_relaxed);
+        auto hits = total.hits[i].load(std::memory_order_relaxed);
+        classes_json.emplace_back(sl::json::value({
+            { "blockSize", static_cast<int64_t>(class_size(i)) },
+            { "allocs", static_cast<int64_t>(allocs) },
+            { "cacheHits", static_cast<int64_t>(hits) },
+            { "cacheHitRate", allocs > 0 ? static_cast<double>(hits) / static_cast<double>(allocs) : 0.0 }
+        }));
+    }
+    return {
+        { "engine", pool_enabled.load() ? "pool" : "malloc" },
+        { "liveBytes", static_cast<int64_t>(total.live_bytes.load(std::memory_order_relaxed)) },
+        { "pooledBytes", static_cast<int64_t>(pooled_bytes.load(std::memory_order_relaxed)) },
+        { "largeAllocs", static_cast<int64_t>(total.large_allocs.load(std::memory_order_relaxed)) },
+        { "arenaAllocs", static_cast<int64_t>(total.arena_allocs.load(std::memory_order_relaxed)) },
+        { "mmapAllocs", static_cast<int64_t>(total.mmap_allocs.load(std::memory_order_relaxed)) },
+        { "mremaps", static_cast<int64_t>(total.mremaps.load(std::memory_order_relaxed)) },
+        { "unknownFrees", static_cast<int64_t>(total.unknown_frees.load(std::memory_order_relaxed)) },
+        { "classes", std::move(classes_json) }
+    };
+}
+
+counters& current_counters() STATICLIB_NOEXCEPT {
+    auto tc = current_cache();
+    if (nullptr != tc) {
+        return tc->stats;
+    }
+    static auto pool = shared_pool();
+    return pool->retired_counters();
+}
+
+char* allocate_pool(size_t idx) STATICLIB_NOEXCEPT {
+    auto tc = current_cache();
+    if (nullptr != tc) {
+        return tc->take(idx);
+    }
+    static auto pool = shared_pool();
+    free_node* node = nullptr;
+    if (1 != pool->take(idx, 1, node)) {
+        return nullptr;
+    }
+    return reinterpret_cast<char*>(node);
+}
+
+void deallocate_pool(size_t idx, char* block) STATICLIB_NOEXCEPT {
+    auto tc = current_cache();
+    if (nullptr != tc) {
+        tc->give(idx, block);
+        return;
+    }
+    static auto pool = shared_pool();
+    auto node = reinterpret_cast<free_node*>(block);
+    pool->give(idx, node, node);
+}
+
+// unknown buffers can only be told apart from 'malloc' ones by their
+// tracking records, they are leaked and listed in the tracking report
+void report_unknown(const char* buffer, const char* fun) STATICLIB_NOEXCEPT {
+    current_counters().unknown_frees.fetch_add(1, std::memory_order_relaxed);
+    track_unknown(buffer, fun);
+}
+
+bool use_mmap(size_t size) STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_LINUX
+    auto threshold = mmap_threshold.load(std::memory_order_relaxed);
+    return 0 != threshold && size >= threshold;
+#else // !STATICLIB_LINUX
+    (void) size;
+    return false;
+#endif // STATICLIB_LINUX
+}
+
+#ifdef STATICLIB_LINUX
+
+size_t page_size() STATICLIB_NOEXCEPT {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t mapped_length(size_t size) STATICLIB_NOEXCEPT {
+    return (size + page_size() - 1) & ~(page_size() - 1);
+}
+
+/**
+ * Sizes of the mapped blocks, looked up only for page aligned
+ * addresses while at least one block is mapped
+ */
+class mmap_table {
+    struct entry {
+        const char* block;
+        size_t size;
+    };
+
+    std::mutex mutex;
+    std::array<entry, max_mmap_blocks> entries;
+    std::atomic<size_t> count;
+
+public:
+    mmap_table() :
+    count(0) { }
+
+    mmap_table(const mmap_table&) = delete;
+
+    mmap_table& operator=(const mmap_table&) = delete;
+
+    bool insert(const char* block, size_t size) STATICLIB_NOEXCEPT {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto cnt = count.load(std::memory_order_relaxed);
+        if (cnt >= entries.size()) {
+            return false;
+        }
+        entries[cnt] = entry{block, size};
+        count.store(cnt + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // returns false for the blocks that are not mapped
+    bool find(const char* block, size_t& size_out) STATICLIB_NOEXCEPT {
+        if (!may_contain(block)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> guard{mutex};
+        auto idx = index_of(block);
+        if (idx >= count.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        size_out = entries[idx].size;
+        return true;
+    }
+
+    bool erase(const char* block, size_t& size_out) STATICLIB_NOEXCEPT {
+        if (!may_contain(block)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> guard{mutex};
+        auto cnt = count.load(std::memory_order_relaxed);
+        auto idx = index_of(block);
+        if (idx >= cnt) {
+            return false;
+        }
+        size_out = entries[idx].size;
+        entries[idx] = entries[cnt - 1];
+        count.store(cnt - 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // block must be in the table
+    void replace(const char* block, const char* moved, size_t size) STATICLIB_NOEXCEPT {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto idx = index_of(block);
+        if (idx < count.load(std::memory_order_relaxed)) {
+            entries[idx] = entry{moved, size};
+        }
+    }
+
+private:
+    bool may_contain(const char* block) const STATICLIB_NOEXCEPT {
+        return 0 != count.load(std::memory_order_relaxed) &&
+                0 == (reinterpret_cast<uintptr_t>(block) & (page_size() - 1));
+    }
+
+    // must be called under mutex
+    size_t index_of(const char* block) const STATICLIB_NOEXCEPT {
+        auto cnt = count.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < cnt; i++) {
+            if (block == entries[i].block) {
+                return i;
+            }
+        }
+        return cnt;
+    }
+};
+
+// never destroyed, mapped buffers can be
+// released by other static destructors
+mmap_table& shared_mapped() {
+    static mmap_table* table = new mmap_table();
+    return *table;
+}
+
+void advise_huge_pages(void* addr, size_t len) STATICLIB_NOEXCEPT {
+#ifdef MADV_HUGEPAGE
+    if (huge_pages_enabled.load(std::memory_order_relaxed)) {
+        // hint only, result is ignored
+        madvise(addr, len, MADV_HUGEPAGE);
+    }
+#else // !MADV_HUGEPAGE
+    (void) addr;
+    (void) len;
+#endif // MADV_HUGEPAGE
+}
+
+char* allocate_mmap(size_t size) STATICLIB_NOEXCEPT {
+    auto len = mapped_length(size);
+    auto addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == addr) {
+        return nullptr;
+    }
+    auto block = static_cast<char*>(addr);
+    if (!shared_mapped().insert(block, size)) {
+        // too many mapped blocks, 'malloc' is used instead
+        munmap(addr, len);
+        return nullptr;
+    }
+    advise_huge_pages(addr, len);
+    current_counters().mmap_allocs.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+
+// grows or shrinks in place when possible, moves without copying otherwise
+char* reallocate_mmap(char* block, size_t old_size, size_t size) STATICLIB_NOEXCEPT {
+    auto old_len = mapped_length(old_size);
+    auto len = mapped_length(size);
+    if (old_len == len) {
+        shared_mapped().replace(block, block, size);
+        return block;
+    }
+    auto addr = mremap(block, old_len, len, MREMAP_MAYMOVE);
+    if (MAP_FAILED == addr) {
+        return nullptr;
+    }
+    if (len > old_len) {
+        advise_huge_pages(addr, len);
+    }
+    auto moved = static_cast<char*>(addr);
+    shared_mapped().replace(block, moved, size);
+    current_counters().mremaps.fetch_add(1, std::memory_order_relaxed);
+    return moved;
+}
+
+#endif // STATICLIB_LINUX
+
+// number of bytes that can be read from the block,
+// used when a 'malloc' block is moved to a mapped one
+size_t malloc_size(char* block) STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_LINUX
+    return malloc_usable_size(block);
+#else // !STATICLIB_LINUX
+    // not moved to mapped blocks on other platforms
+    (void) block;
+    return 0;
+#endif // STATICLIB_LINUX
+}
+
+} // namespace
+
+char* allocate(size_t size) STATICLIB_NOEXCEPT {
+    if (nullptr != current_arena_ptr) {
+        auto block = current_arena_ptr->allocate(size);
+        if (nullptr != block) {
+            current_counters().arena_allocs.fetch_add(1, std::memory_order_relaxed);
+        }
+        return block;
+    }
+    char* block = nullptr;
+    if (pool_enabled.load(std::memory_order_relaxed)) {
+        auto idx = class_index(size);
+        if (idx < classes_count) {
+            block = allocate_pool(idx);
+            if (nullptr != block) {
+                current_counters().live_bytes.fetch_add(static_cast<int64_t>(class_size(idx)),
+                        std::memory_order_relaxed);
+            }
+        }
+    }
+#ifdef STATICLIB_LINUX
+    if (nullptr == block && use_mmap(size)) {
+        block = allocate_mmap(size);
+        if (nullptr != block) {
+            current_counters().live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        }
+    }
+#endif // STATICLIB_LINUX
+    if (nullptr == block) {
+        // passed as is, not counted in 'liveBytes'
+        block = static_cast<char*>(std::malloc(size));
+        if (nullptr == block) {
+            return nullptr;
+        }
+        current_counters().large_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (tracking_enabled()) {
+        track_alloc(block, size, 0);
+    }
+    return block;
+}
+
+void deallocate(char* buffer) STATICLIB_NOEXCEPT {
+    if (nullptr == buffer) {
+        return;
+    }
+    static auto pool = shared_pool();
+    auto idx = pool->find_class(buffer);
+    if (idx < classes_count) {
+        if (tracking_enabled()) {
+            track_free(buffer);
+        }
+        current_counters().live_bytes.fetch_sub(static_cast<int64_t>(class_size(idx)), std::memory_order_relaxed);
+        deallocate_pool(idx, buffer);
+        return;
+    }
+#ifdef STATICLIB_LINUX
+    size_t mapped_size = 0;
+    if (shared_mapped().erase(buffer, mapped_size)) {
+        if (tracking_enabled()) {
+            track_free(buffer);
+        }
+        current_counters().live_bytes.fetch_sub(static_cast<int64_t>(mapped_size), std::memory_order_relaxed);
+        munmap(buffer, mapped_length(mapped_size));
+        return;
+    }
+#endif // STATICLIB_LINUX
+    if (0 != shared_chunks().find(buffer)) {
+        // released when the arena is closed
+        return;
+    }
+    if (tracking_enabled() && !track_free(buffer)) {
+        report_unknown(buffer, "wilton_free");
+        return;
+    }
+    std::free(buffer);
+}
+
+char* reallocate(char* buffer, size_t size) STATICLIB_NOEXCEPT {
+    if (nullptr == buffer) {
+        return allocate(size);
+    }
+    static auto pool = shared_pool();
+    // bytes that can be copied from the buffer when it is moved
+    size_t old_size = 0;
+    auto idx = pool->find_class(buffer);
+#ifdef STATICLIB_LINUX
+    size_t mapped_size = 0;
+#endif // STATICLIB_LINUX
+    size_t chunk_rest = 0;
+    if (idx < classes_count) {
+        if (class_size(idx) >= size) {
+            if (tracking_enabled()) {
+                track_resize(buffer, buffer, size);
+            }
+            return buffer;
+        }
+        old_size = class_size(idx);
+#ifdef STATICLIB_LINUX
+    } else if (shared_mapped().find(buffer, mapped_size)) {
+        if (use_mmap(size)) {
+            auto resized = reallocate_mmap(buffer, mapped_size, size);
+            if (nullptr != resized) {
+                current_counters().live_bytes.fetch_add(static_cast<int64_t>(size) - static_cast<int64_t>(mapped_size),
+                        std::memory_order_relaxed);
+                if (tracking_enabled()) {
+                    track_resize(buffer, resized, size);
+                }
+                return resized;
+            }
+        }
+        old_size = mapped_size;
+#endif // STATICLIB_LINUX
+    } else if (0 != (chunk_rest = shared_chunks().find(buffer))) {
+        // block size is not kept, the rest of its chunk is readable
+        old_size = chunk_rest;
+    } else if (tracking_enabled()) {
+        // tracked blocks are moved, their records are replaced on allocation and free
+        uint64_t tracked_size = 0;
+        if (!find_tracked(buffer, tracked_size)) {
+            report_unknown(buffer, "wilton_realloc");
+            return nullptr;
+        }
+        old_size = static_cast<size_t>(tracked_size);
+    } else if (!use_mmap(size)) {
+        return static_cast<char*>(std::realloc(buffer, size));
+    } else {
+        old_size = malloc_size(buffer);
+    }
+    // different kind is needed or resizing failed, data is moved to a new block
+    auto res = allocate(size);
+    if (nullptr == res) {
+        return nullptr;
+    }
+    // rest of an arena chunk can overlap the new block
+    std::memmove(res, buffer, std::min(size, old_size));
+    deallocate(buffer);
+    return res;
+}
+
+char* allocate_detached(size_t size) STATICLIB_NOEXCEPT {
+    auto ar = current_arena_ptr;
+    current_arena_ptr = nullptr;
+    auto res = allocate(size);
+    current_arena_ptr = ar;
+    return res;
+}
+
+char* detach(char* buffer, size_t size) STATICLIB_NOEXCEPT {
+    if (nullptr == buffer || !is_arena_block(buffer)) {
+        return buffer;
+    }
+    auto res = allocate_detached(size);
+    if (nullptr != res) {
+        std::memcpy(res, buffer, size);
+    }
+    return res;
+}
+
+bool is_arena_block(const char* buffer) STATICLIB_NOEXCEPT {
+    return 0 != shared_chunks().find(buffer);
+}
+
+bool register_arena_chunk(const char* chunk, size_t size) STATICLIB_NOEXCEPT {
+    return shared_chunks().insert(chunk, size);
+}
+
+void unregister_arena_chunk(const char* chunk) STATICLIB_NOEXCEPT {
+    shared_chunks().erase(chunk);
+}
+
+void set_engine(const std::string& engine_name) {
+    if ("pool" == engine_name) {
+        pool_enabled.store(true);
+    } else if ("malloc" == engine_name) {
+        pool_enabled.store(false);
+    } else {
+        throw support::exception(TRACEMSG("Invalid allocator engine specified: [" + engine_name + "]," +
+                " supported engines: [malloc, pool]"));
+    }
+}
+
+arena* current_arena() STATICLIB_NOEXCEPT {
+    return current_arena_ptr;
+}
+
+void set_current_arena(arena* ar) STATICLIB_NOEXCEPT {
+    current_arena_ptr = ar;
+}
+
+void set_mmap_threshold(size_t threshold) STATICLIB_NOEXCEPT {
+    mmap_threshold.store(threshold, std::memory_order_relaxed);
+}
+
+void set_huge_pages_enabled(bool enabled) STATICLIB_NOEXCEPT {
+    huge_pages_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+sl::json::value stats() {
+    auto pool = shared_pool();
+    return pool->stats();
+}
+
+} // namespace
+}
@@ -0,0 +1,62 @@
+/*
+ * File:   allocator.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 6:40 PM
+ */
+
+#ifndef WILTON_ALLOC_ALLOCATOR_HPP
+#define WILTON_ALLOC_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+#include "alloc/arena.hpp"
+
+namespace wilton {
+namespace alloc {
+
+char* allocate(size_t size) STATICLIB_NOEXCEPT;
+
+void deallocate(char* buffer) STATICLIB_NOEXCEPT;
+
+// returns null and keeps the buffer on failure
+char* reallocate(char* buffer, size_t size) STATICLIB_NOEXCEPT;
+
+// bypasses the current arena, for buffers that can outlive it
+char* allocate_detached(size_t size) STATICLIB_NOEXCEPT;
+
+// returns arena buffers copied with 'allocate_detached' and
+// other buffers as is, null if the copy cannot be allocated
+char* detach(char* buffer, size_t size) STATICLIB_NOEXCEPT;
+
+// true for buffers allocated from an arena that is still open
+bool is_arena_block(const char* buffer) STATICLIB_NOEXCEPT;
+
+// "malloc" (default) or "pool", selected at init; "malloc" passes
+// the buffers to 'malloc' and 'free' as is, pool, arena and mmap
+// blocks are told apart by their address ranges
+void set_engine(const std::string& engine_name);
+
+// blocks of at least this size are mapped
+// directly with 'mmap' and resized with 'mremap', zero disables
+void set_mmap_threshold(size_t threshold) STATICLIB_NOEXCEPT;
+
+void set_huge_pages_enabled(bool enabled) STATICLIB_NOEXCEPT;
+
+// innermost arena opened on this thread, all
+// the allocations go to it while it is set
+arena* current_arena() STATICLIB_NOEXCEPT;
+
+void set_current_arena(arena* ar) STATICLIB_NOEXCEPT;
+
+sl::json::value stats();
+
+} // namespace
+}
+
+#endif /* WILTON_ALLOC_ALLOCATOR_HPP */
@@ -0,0 +1,107 @@
+/*
+ * File:   arena.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 7:50 PM
+ */
+
+#ifndef WILTON_ALLOC_ARENA_HPP
+#define WILTON_ALLOC_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+namespace wilton {
+namespace alloc {
+
+// defined in allocator, chunk ranges tell arena blocks apart on 'wilton_free'
+bool register_arena_chunk(const char* chunk, size_t size) STATICLIB_NOEXCEPT;
+
+void unregister_arena_chunk(const char* chunk) STATICLIB_NOEXCEPT;
+
+/**
+ * Bump allocator over a list of chunks, all the memory
+ * is released at once when the arena is destroyed
+ */
+class arena {
+    static const size_t alignment = 16;
+
+    const size_t chunk_size;
+    arena* const parent;
+    std::vector<char*> chunks;
+    char* pos = nullptr;
+    char* end = nullptr;
+    size_t allocated = 0;
+
+public:
+    arena(size_t chunk_size, arena* parent) :
+    chunk_size(chunk_size),
+    parent(parent) {
+        chunks.reserve(8);
+    }
+
+    arena(const arena&) = delete;
+
+    arena& operator=(const arena&) = delete;
+
+    ~arena() STATICLIB_NOEXCEPT {
+        for (auto ch : chunks) {
+            unregister_arena_chunk(ch);
+            std::free(ch);
+        }
+    }
+
+    char* allocate(size_t size) STATICLIB_NOEXCEPT {
+        auto len = (size + alignment - 1) & ~(alignment - 1);
+        if (static_cast<size_t>(end - pos) < len) {
+            // large blocks get their own chunk, current chunk is kept
+            auto ch_size = std::max(chunk_size, len);
+            auto ch = static_cast<char*>(std::malloc(ch_size));
+            if (nullptr == ch) {
+                return nullptr;
+            }
+            try {
+                chunks.push_back(ch);
+            } catch (...) {
+                std::free(ch);
+                return nullptr;
+            }
+            if (!register_arena_chunk(ch, ch_size)) {
+                chunks.pop_back();
+                std::free(ch);
+                return nullptr;
+            }
+            if (ch_size > chunk_size) {
+                allocated += len;
+                return ch;
+            }
+            pos = ch;
+            end = ch + ch_size;
+        }
+        auto res = pos;
+        pos += len;
+        allocated += len;
+        return res;
+    }
+
+    arena* get_parent() STATICLIB_NOEXCEPT {
+        return parent;
+    }
+
+    size_t allocated_bytes() const STATICLIB_NOEXCEPT {
+        return allocated;
+    }
+
+    size_t chunks_count() const STATICLIB_NOEXCEPT {
+        return chunks.size();
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_ALLOC_ARENA_HPP */
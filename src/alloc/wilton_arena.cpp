@@ -0,0 +1,71 @@
+/*
+ * File:   wilton_arena.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 8:10 PM
+ */
+
+#include "wilton/wilton.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "staticlib/config.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/alloc_copy.hpp"
+
+#include "alloc/allocator.hpp"
+
+namespace { // anonymous
+
+const int default_chunk_size = 1 << 16;
+
+} // namespace
+
+struct wilton_Arena {
+private:
+    std::thread::id owner_tid;
+    wilton::alloc::arena ar;
+
+public:
+    wilton_Arena(size_t chunk_size, wilton::alloc::arena* parent) :
+    owner_tid(std::this_thread::get_id()),
+    ar(chunk_size, parent) { }
+
+    wilton::alloc::arena& impl() {
+        return ar;
+    }
+
+    const std::thread::id& owner() {
+        return owner_tid;
+    }
+};
+
+char* wilton_arena_open(int chunk_size_bytes, wilton_Arena** arena_out) /* noexcept */ {
+    if (!sl::support::is_uint32(chunk_size_bytes)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'chunk_size_bytes' parameter specified: [" + sl::support::to_string(chunk_size_bytes) + "]"));
+    if (nullptr == arena_out) return wilton::support::alloc_copy(TRACEMSG("Null 'arena_out' parameter specified"));
+    try {
+        auto chunk_size = chunk_size_bytes > 0 ? chunk_size_bytes : default_chunk_size;
+        auto parent = wilton::alloc::current_arena();
+        wilton_Arena* arena_ptr = new wilton_Arena(static_cast<size_t>(chunk_size), parent);
+        wilton::alloc::set_current_arena(std::addressof(arena_ptr->impl()));
+        *arena_out = arena_ptr;
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_arena_close(wilton_Arena* arena) /* noexcept */ {
+    if (nullptr == arena) return wilton::support::alloc_copy(TRACEMSG("Null 'arena' parameter specified"));
+    if (std::this_thread::get_id() != arena->owner()) return wilton::support::alloc_copy(TRACEMSG(
+            "Arena must be closed on the thread it was opened on"));
+    if (std::addressof(arena->impl()) != wilton::alloc::current_arena()) return wilton::support::alloc_copy(TRACEMSG(
+            "Arena must be closed after all the arenas nested into it"));
+    wilton::alloc::set_current_arena(arena->impl().get_parent());
+    delete arena;
+    return nullptr;
+}
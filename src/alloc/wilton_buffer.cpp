@@ -0,0 +1,110 @@
+/*
+ * File:   wilton_buffer.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 9:05 PM
+ */
+
+#include "wilton/wilton.h"
+
+#include <atomic>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/alloc_copy.hpp"
+
+#include "alloc/allocator.hpp"
+
+struct wilton_Buffer {
+private:
+    std::atomic<uint32_t> refcount;
+    char* data;
+    int data_len;
+
+public:
+    wilton_Buffer(char* data, int data_len) :
+    refcount(1),
+    data(data),
+    data_len(data_len) { }
+
+    wilton_Buffer(const wilton_Buffer&) = delete;
+
+    wilton_Buffer& operator=(const wilton_Buffer&) = delete;
+
+    ~wilton_Buffer() STATICLIB_NOEXCEPT {
+        wilton_free(data);
+    }
+
+    // arena blocks are released with the arena, buffer can outlive it,
+    // returns false if the data cannot be copied
+    bool detach() STATICLIB_NOEXCEPT {
+        auto owned = wilton::alloc::detach(data, static_cast<size_t>(data_len));
+        if (nullptr == owned) {
+            return false;
+        }
+        data = owned;
+        return true;
+    }
+
+    void retain() STATICLIB_NOEXCEPT {
+        refcount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // returns true when the last reference is released
+    bool release() STATICLIB_NOEXCEPT {
+        return 1 == refcount.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    const char* get_data() const STATICLIB_NOEXCEPT {
+        return data;
+    }
+
+    int get_data_len() const STATICLIB_NOEXCEPT {
+        return data_len;
+    }
+};
+
+char* wilton_buffer_wrap(char* data, int data_len, wilton_Buffer** buffer_out) /* noexcept */ {
+    if (nullptr == data) return wilton::support::alloc_copy(TRACEMSG("Null 'data' parameter specified"));
+    if (!sl::support::is_uint32(data_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'data_len' parameter specified: [" + sl::support::to_string(data_len) + "]"));
+    if (nullptr == buffer_out) return wilton::support::alloc_copy(TRACEMSG("Null 'buffer_out' parameter specified"));
+    try {
+        wilton_Buffer* buffer_ptr = new wilton_Buffer(data, data_len);
+        if (!buffer_ptr->detach()) {
+            // 'data' stays with the caller, freeing arena block does nothing
+            delete buffer_ptr;
+            return wilton::support::alloc_copy(TRACEMSG("Cannot copy arena 'data', size: [" +
+                    sl::support::to_string(data_len) + "]"));
+        }
+        *buffer_out = buffer_ptr;
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_buffer_retain(wilton_Buffer* buffer) /* noexcept */ {
+    if (nullptr == buffer) return wilton::support::alloc_copy(TRACEMSG("Null 'buffer' parameter specified"));
+    buffer->retain();
+    return nullptr;
+}
+
+char* wilton_buffer_release(wilton_Buffer* buffer) /* noexcept */ {
+    if (nullptr == buffer) return wilton::support::alloc_copy(TRACEMSG("Null 'buffer' parameter specified"));
+    if (buffer->release()) {
+        delete buffer;
+    }
+    return nullptr;
+}
+
+char* wilton_buffer_data(wilton_Buffer* buffer, const char** data_out, int* data_len_out) /* noexcept */ {
+    if (nullptr == buffer) return wilton::support::alloc_copy(TRACEMSG("Null 'buffer' parameter specified"));
+    if (nullptr == data_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out' parameter specified"));
+    if (nullptr == data_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_len_out' parameter specified"));
+    *data_out = buffer->get_data();
+    *data_len_out = buffer->get_data_len();
+    return nullptr;
+}
@@ -0,0 +1,43 @@
+/*
+ * File:   wiltoncall_alloc.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 7:25 PM
+ */
+
+#include "call/wiltoncall_internal.hpp"
+
+#include "alloc/allocator.hpp"
+#include "alloc/alloc_tracking.hpp"
+
+namespace wilton {
+namespace alloc {
+
+support::buffer get_alloc_stats(sl::io::span<const char>) {
+    return support::make_json_result(stats());
+}
+
+support::buffer get_alloc_tracking(const support::json_view& data) {
+    // json parse
+    auto root = data.root();
+    if (sl::json::type::object != root.json_type()) {
+        throw support::exception(TRACEMSG("Invalid non-object input specified"));
+    }
+    uint32_t limit = 100;
+    root.for_each_field([&limit](const std::string& name, const support::json_node& val) {
+        if ("limit" == name) {
+            auto num = val.as_int64_or_throw(name);
+            if (!sl::support::is_uint32(num)) {
+                throw support::exception(TRACEMSG("Invalid 'limit' value: [" + sl::support::to_string(num) + "]"));
+            }
+            limit = static_cast<uint32_t>(num);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    });
+    // call
+    return support::make_json_buffer(tracking_report(limit));
+}
+
+} // namespace
+}
@@ -0,0 +1,237 @@
+/*
+ * File:   call_registry.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+#ifndef WILTON_CALL_CALL_REGISTRY_HPP
+#define WILTON_CALL_CALL_REGISTRY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/wiltoncall.h"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace call {
+
+class call_stats;
+class result_cache;
+
+using cb_ctx_type = void*;
+using cb_fun_type = char* (*)(void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len);
+using into_fun_type = char* (*)(void* call_ctx, const char* json_in, int json_in_len,
+        char* out_buf, int out_buf_cap, int* json_out_len);
+
+/**
+ * Registered call, entries are immutable after registration
+ * and are kept alive by in-flight calls after their removal
+ */
+class call_entry {
+public:
+    const std::string name;
+    const cb_ctx_type cb_ctx;
+    // at least one of the callbacks is set
+    const cb_fun_type cb_fun;
+    const into_fun_type into_fun;
+    // set only for calls registered as cacheable
+    const std::shared_ptr<result_cache> cache;
+    // 'WILTONCALL_FORMAT_*' of the callback payloads
+    const int payload_format;
+    std::atomic<bool> removed;
+    // set on first call with stats enabled
+    std::atomic<call_stats*> stats;
+    // set on first call with allocations tracking enabled
+    std::atomic<uint16_t> alloc_origin;
+
+    call_entry(const std::string& name, cb_ctx_type cb_ctx, cb_fun_type cb_fun,
+            into_fun_type into_fun, std::shared_ptr<result_cache> cache, int payload_format) :
+    name(name.data(), name.length()),
+    cb_ctx(cb_ctx),
+    cb_fun(cb_fun),
+    into_fun(into_fun),
+    cache(std::move(cache)),
+    payload_format(payload_format),
+    removed(false),
+    stats(nullptr),
+    alloc_origin(0) { }
+
+    call_entry(const call_entry&) = delete;
+
+    call_entry& operator=(const call_entry&) = delete;
+};
+
+/**
+ * Read-mostly registry of calls, lookups do not take any locks,
+ * modifications publish a new immutable snapshot and wait for
+ * the readers of the previous one to leave before deleting it
+ */
+class call_registry {
+    using snapshot_type = std::unordered_map<std::string, std::shared_ptr<call_entry>>;
+
+    static const size_t max_entries_count = 1 << 16;
+    static const size_t readers_shards_count = 64;
+
+    // counter per cache line to not bounce it between readers
+    struct readers_counter {
+        std::atomic<size_t> count;
+        char padding[64 - sizeof(std::atomic<size_t>)];
+
+        readers_counter() :
+        count(0) { }
+    };
+
+    std::atomic<const snapshot_type*> current;
+    std::atomic<uint32_t> epoch;
+    std::array<std::array<readers_counter, readers_shards_count>, 2> readers;
+    std::mutex write_mutex;
+
+public:
+    call_registry() :
+    current(new snapshot_type()),
+    epoch(0) { }
+
+    call_registry(const call_registry&) = delete;
+
+    call_registry& operator=(const call_registry&) = delete;
+
+    ~call_registry() STATICLIB_NOEXCEPT {
+        delete current.load();
+    }
+
+    void put(const std::string& name, cb_ctx_type cb_ctx, cb_fun_type cb_fun,
+            std::shared_ptr<result_cache> cache = std::shared_ptr<result_cache>(),
+            into_fun_type into_fun = nullptr, int payload_format = WILTONCALL_FORMAT_JSON) {
+        if (name.empty()) throw support::exception(TRACEMSG(
+                "Invalid empty 'wiltoncall' name specified"));
+        if (nullptr == cb_fun && nullptr == into_fun) throw support::exception(TRACEMSG(
+                "Invalid null 'wiltoncall' function specified for name: [" + name + "]"));
+        std::lock_guard<std::mutex> guard{write_mutex};
+        auto snap = current.load();
+        if (snap->size() >= max_entries_count) throw support::exception(TRACEMSG(
+                "'wiltoncall' registry size exceeded, max size: [" + sl::support::to_string(static_cast<size_t>(max_entries_count)) + "]"));
+        if (0 != snap->count(name)) throw support::exception(TRACEMSG(
+                "Invalid duplicate 'wiltoncall' name specified: [" + name + "]"));
+        auto next = new snapshot_type(*snap);
+        try {
+            next->insert(std::make_pair(name, std::make_shared<call_entry>(name, cb_ctx, cb_fun, into_fun,
+                    std::move(cache), payload_format)));
+        } catch (...) {
+            delete next;
+            throw;
+        }
+        publish(next);
+    }
+
+    std::shared_ptr<call_entry> get(const std::string& name) {
+        if (name.empty()) throw support::exception(TRACEMSG(
+                "Invalid empty 'wiltoncall' name specified"));
+        auto res = find(name);
+        if (nullptr == res.get()) throw support::exception(TRACEMSG(
+                "Invalid unknown 'wiltoncall' name specified: [" + name + "]"));
+        return res;
+    }
+
+    void remove(const std::string& name) {
+        if (name.empty()) throw support::exception(TRACEMSG(
+                "Invalid empty 'wiltoncall' name specified"));
+        std::lock_guard<std::mutex> guard{write_mutex};
+        auto snap = current.load();
+        auto it = snap->find(name);
+        if (snap->end() == it) throw support::exception(TRACEMSG(
+                "Invalid unknown 'wiltoncall' name specified: [" + name + "]"));
+        auto entry = it->second;
+        auto next = new snapshot_type(*snap);
+        next->erase(name);
+        publish(next);
+        entry->removed.store(true);
+    }
+
+    // returns empty pointer if not found
+    std::shared_ptr<call_entry> find(const std::string& name) STATICLIB_NOEXCEPT {
+        auto& counter = enter_read();
+        auto snap = current.load();
+        auto res = std::shared_ptr<call_entry>();
+        auto it = snap->find(name);
+        if (snap->end() != it) {
+            res = it->second;
+        }
+        counter.fetch_sub(1);
+        return res;
+    }
+
+    // resolves all names against a single snapshot, empty pointers
+    // are returned for invalid and unknown names
+    void find_all(const char** names, const int* names_lens, size_t count,
+            std::vector<std::shared_ptr<call_entry>>& res) {
+        res.reserve(res.size() + count);
+        auto key = std::string();
+        auto& counter = enter_read();
+        auto deferred = sl::support::defer([&counter]() STATICLIB_NOEXCEPT {
+            counter.fetch_sub(1);
+        });
+        auto snap = current.load();
+        for (size_t i = 0; i < count; i++) {
+            auto en = std::shared_ptr<call_entry>();
+            if (nullptr != names[i] && sl::support::is_uint16_positive(names_lens[i])) {
+                key.assign(names[i], static_cast<uint16_t> (names_lens[i]));
+                auto it = snap->find(key);
+                if (snap->end() != it) {
+                    en = it->second;
+                }
+            }
+            res.emplace_back(std::move(en));
+        }
+    }
+
+private:
+    std::atomic<size_t>& enter_read() STATICLIB_NOEXCEPT {
+        static std::atomic<size_t> next_shard{0};
+        thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % readers_shards_count;
+        for (;;) {
+            auto ep = epoch.load();
+            auto& counter = readers[ep][shard].count;
+            counter.fetch_add(1);
+            // writer may have flipped the epoch and drained these counters
+            // before the increment, snapshot seen then is not protected by them
+            if (ep == epoch.load()) {
+                return counter;
+            }
+            counter.fetch_sub(1);
+        }
+    }
+
+    // must be called under write_mutex
+    void publish(const snapshot_type* next) STATICLIB_NOEXCEPT {
+        auto prev = current.exchange(next);
+        // readers that entered before the flip may still use the previous snapshot,
+        // new readers use another set of counters and can only see the new one
+        auto ep = epoch.load();
+        epoch.store(ep ^ 1);
+        for (auto& rc : readers[ep]) {
+            while (0 != rc.count.load()) {
+                std::this_thread::yield();
+            }
+        }
+        delete prev;
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CALL_CALL_REGISTRY_HPP */
@@ -0,0 +1,239 @@
+/*
+ * File:   call_stats.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 2:20 PM
+ */
+
+#ifndef WILTON_CALL_CALL_STATS_HPP
+#define WILTON_CALL_CALL_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace call {
+
+/**
+ * Log-linear latency histogram (HDR-style with 3 significant bits),
+ * values from 0 to 2^40 nanoseconds are recorded with 12.5% precision
+ */
+class latency_histogram {
+public:
+    static const uint32_t sub_buckets_bits = 3;
+    static const uint32_t sub_buckets_count = 1 << sub_buckets_bits;
+    static const uint32_t max_magnitude = 39;
+    static const uint32_t buckets_count = (max_magnitude - 1) * sub_buckets_count;
+
+private:
+    std::array<std::atomic<uint64_t>, buckets_count> buckets;
+
+public:
+    latency_histogram() {
+        reset();
+    }
+
+    latency_histogram(const latency_histogram&) = delete;
+
+    latency_histogram& operator=(const latency_histogram&) = delete;
+
+    void record(uint64_t value) STATICLIB_NOEXCEPT {
+        buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count_at(uint32_t idx) const STATICLIB_NOEXCEPT {
+        return buckets[idx].load(std::memory_order_relaxed);
+    }
+
+    void reset() STATICLIB_NOEXCEPT {
+        for (auto& bu : buckets) {
+            bu.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static uint32_t bucket_index(uint64_t value) STATICLIB_NOEXCEPT {
+        if (value < sub_buckets_count) {
+            return static_cast<uint32_t>(value);
+        }
+        auto mag = msb_position(value);
+        if (mag > max_magnitude) {
+            return buckets_count - 1;
+        }
+        auto sub = static_cast<uint32_t>(value >> (mag - sub_buckets_bits)) & (sub_buckets_count - 1);
+        return (mag - sub_buckets_bits + 1) * sub_buckets_count + sub;
+    }
+
+    // highest value that falls into the specified bucket
+    static uint64_t bucket_value(uint32_t idx) STATICLIB_NOEXCEPT {
+        if (idx < sub_buckets_count) {
+            return idx;
+        }
+        auto mag = idx / sub_buckets_count + sub_buckets_bits - 1;
+        auto sub = idx % sub_buckets_count;
+        auto width = static_cast<uint64_t>(1) << (mag - sub_buckets_bits);
+        return (static_cast<uint64_t>(sub_buckets_count + sub) << (mag - sub_buckets_bits)) + width - 1;
+    }
+
+private:
+    static uint32_t msb_position(uint64_t value) STATICLIB_NOEXCEPT {
+#ifdef __GNUC__
+        return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#else // !__GNUC__
+        uint32_t res = 0;
+        while (value >>= 1) {
+            res += 1;
+        }
+        return res;
+#endif // __GNUC__
+    }
+};
+
+/**
+ * Counters of a single call name, sharded by thread
+ * to not bounce counters cache lines between callers
+ */
+class call_stats {
+    static const size_t shards_count = 8;
+
+    struct shard {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> errors;
+        std::atomic<uint64_t> bytes_in;
+        std::atomic<uint64_t> bytes_out;
+        std::atomic<uint64_t> latency_total;
+        std::atomic<uint64_t> latency_max;
+        latency_histogram latency;
+        char padding[64];
+
+        shard() {
+            reset();
+        }
+
+        void reset() STATICLIB_NOEXCEPT {
+            count.store(0, std::memory_order_relaxed);
+            errors.store(0, std::memory_order_relaxed);
+            bytes_in.store(0, std::memory_order_relaxed);
+            bytes_out.store(0, std::memory_order_relaxed);
+            latency_total.store(0, std::memory_order_relaxed);
+            latency_max.store(0, std::memory_order_relaxed);
+            latency.reset();
+        }
+    };
+
+    const std::string call_name;
+    std::array<shard, shards_count> shards;
+
+public:
+    call_stats(const std::string& call_name) :
+    call_name(call_name.data(), call_name.length()) { }
+
+    call_stats(const call_stats&) = delete;
+
+    call_stats& operator=(const call_stats&) = delete;
+
+    const std::string& name() const {
+        return call_name;
+    }
+
+    void record(bool failed, uint64_t bytes_in, uint64_t bytes_out, uint64_t latency_nanos) STATICLIB_NOEXCEPT {
+        static std::atomic<size_t> next_shard{0};
+        thread_local size_t idx = next_shard.fetch_add(1, std::memory_order_relaxed) % shards_count;
+        auto& sh = shards[idx];
+        sh.count.fetch_add(1, std::memory_order_relaxed);
+        if (failed) {
+            sh.errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        sh.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+        sh.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+        sh.latency_total.fetch_add(latency_nanos, std::memory_order_relaxed);
+        auto prev_max = sh.latency_max.load(std::memory_order_relaxed);
+        while (prev_max < latency_nanos && !sh.latency_max.compare_exchange_weak(prev_max, latency_nanos,
+                std::memory_order_relaxed)) { }
+        sh.latency.record(latency_nanos);
+    }
+
+    void reset() STATICLIB_NOEXCEPT {
+        for (auto& sh : shards) {
+            sh.reset();
+        }
+    }
+
+    sl::json::value to_json() const {
+        uint64_t count = 0;
+        uint64_t errors = 0;
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        uint64_t latency_total = 0;
+        uint64_t latency_max = 0;
+        auto merged = std::array<uint64_t, latency_histogram::buckets_count>();
+        merged.fill(0);
+        for (auto& sh : shards) {
+            count += sh.count.load(std::memory_order_relaxed);
+            errors += sh.errors.load(std::memory_order_relaxed);
+            bytes_in += sh.bytes_in.load(std::memory_order_relaxed);
+            bytes_out += sh.bytes_out.load(std::memory_order_relaxed);
+            latency_total += sh.latency_total.load(std::memory_order_relaxed);
+            auto sh_max = sh.latency_max.load(std::memory_order_relaxed);
+            latency_max = sh_max > latency_max ? sh_max : latency_max;
+            for (uint32_t i = 0; i < latency_histogram::buckets_count; i++) {
+                merged[i] += sh.latency.count_at(i);
+            }
+        }
+        uint64_t recorded = 0;
+        for (auto co : merged) {
+            recorded += co;
+        }
+        auto percentile = [&merged, recorded, latency_max](double pc) -> int64_t {
+            if (0 == recorded) return 0;
+            auto threshold = static_cast<uint64_t>(static_cast<double>(recorded) * pc / 100.0);
+            uint64_t cumulative = 0;
+            for (uint32_t i = 0; i < latency_histogram::buckets_count; i++) {
+                cumulative += merged[i];
+                if (cumulative > threshold) {
+                    auto val = latency_histogram::bucket_value(i);
+                    return static_cast<int64_t>(val < latency_max ? val : latency_max);
+                }
+            }
+            return static_cast<int64_t>(latency_max);
+        };
+        return {
+            { "name", call_name },
+            { "count", static_cast<int64_t>(count) },
+            { "errors", static_cast<int64_t>(errors) },
+            { "bytesIn", static_cast<int64_t>(bytes_in) },
+            { "bytesOut", static_cast<int64_t>(bytes_out) },
+            { "latencyNanos", {
+                { "mean", static_cast<int64_t>(count > 0 ? latency_total / count : 0) },
+                { "p50", percentile(50) },
+                { "p90", percentile(90) },
+                { "p99", percentile(99) },
+                { "p999", percentile(99.9) },
+                { "max", static_cast<int64_t>(latency_max) }
+            }}
+        };
+    }
+};
+
+// disabled stats are checked with a single relaxed load
+bool stats_enabled() STATICLIB_NOEXCEPT;
+
+void stats_enable(bool enabled) STATICLIB_NOEXCEPT;
+
+// lazily creates stats for the specified name, stats are never deleted
+call_stats* stats_for(const std::string& call_name);
+
+inline uint64_t stats_now_nanos() STATICLIB_NOEXCEPT {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+} // namespace
+}
+
+#endif /* WILTON_CALL_CALL_STATS_HPP */
@@ -0,0 +1,227 @@
+/*
+ * File:   result_cache.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 5:30 PM
+ */
+
+#ifndef WILTON_CALL_RESULT_CACHE_HPP
+#define WILTON_CALL_RESULT_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+#include "wilton/wilton.h"
+
+namespace wilton {
+namespace call {
+
+/**
+ * Results of a call declared as idempotent, keyed by payload hash,
+ * entries are evicted after TTL or when the shard is full (LRU);
+ * shard capacities add up to the max entries count
+ */
+class result_cache {
+    static const size_t shards_count = 16;
+
+    struct item {
+        std::string payload;
+        std::string result;
+        bool has_result;
+        uint64_t expires_at;
+        std::list<uint64_t>::iterator lru_pos;
+    };
+
+    struct shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, item> items;
+        std::list<uint64_t> lru;
+        size_t max_entries = 0;
+    };
+
+    const std::string call_name;
+    const uint64_t ttl_millis;
+    // fewer shards are used for small caches
+    const size_t used_shards_count;
+    std::array<shard, shards_count> shards;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+
+public:
+    // zero TTL means no expiration
+    result_cache(const std::string& call_name, uint32_t ttl_millis, uint32_t max_entries) :
+    call_name(call_name.data(), call_name.length()),
+    ttl_millis(ttl_millis),
+    used_shards_count(shards_for(max_entries)),
+    hits(0),
+    misses(0),
+    evictions(0) {
+        for (size_t i = 0; i < used_shards_count; i++) {
+            shards[i].max_entries = max_entries / used_shards_count +
+                    (i < max_entries % used_shards_count ? 1 : 0);
+        }
+    }
+
+    result_cache(const result_cache&) = delete;
+
+    result_cache& operator=(const result_cache&) = delete;
+
+    static uint64_t payload_hash(const char* data, size_t len) STATICLIB_NOEXCEPT {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < len; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // on hit the result is copied into a new wilton_alloc buffer
+    bool get(uint64_t hash, const char* json_in, size_t json_in_len,
+            char** json_out, int* json_out_len) STATICLIB_NOEXCEPT {
+        auto& sh = shards[hash % used_shards_count];
+        std::lock_guard<std::mutex> guard{sh.mutex};
+        auto found = find_live(sh, hash, json_in, json_in_len);
+        if (nullptr == found) {
+            return false;
+        }
+        auto& it_val = *found;
+        char* out = nullptr;
+        if (it_val.has_result) {
+            out = wilton_alloc(static_cast<int>(it_val.result.length() > 0 ? it_val.result.length() : 1));
+            if (nullptr == out) {
+                misses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            std::memcpy(out, it_val.result.data(), it_val.result.length());
+        }
+        sh.lru.splice(sh.lru.begin(), sh.lru, it_val.lru_pos);
+        *json_out = out;
+        *json_out_len = static_cast<int>(it_val.result.length());
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // on hit the result is copied into 'out_buf' when it fits,
+    // 'json_out_len' is set to the full result length
+    bool get_into(uint64_t hash, const char* json_in, size_t json_in_len,
+            char* out_buf, size_t out_buf_cap, int* json_out_len) STATICLIB_NOEXCEPT {
+        auto& sh = shards[hash % used_shards_count];
+        std::lock_guard<std::mutex> guard{sh.mutex};
+        auto found = find_live(sh, hash, json_in, json_in_len);
+        if (nullptr == found) {
+            return false;
+        }
+        auto& it_val = *found;
+        auto len = it_val.result.length();
+        if (len > 0 && len <= out_buf_cap) {
+            std::memcpy(out_buf, it_val.result.data(), len);
+        }
+        sh.lru.splice(sh.lru.begin(), sh.lru, it_val.lru_pos);
+        *json_out_len = static_cast<int>(len);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void put(uint64_t hash, const char* json_in, size_t json_in_len,
+            const char* json_out, size_t json_out_len) STATICLIB_NOEXCEPT {
+        auto& sh = shards[hash % used_shards_count];
+        if (0 == sh.max_entries) {
+            return;
+        }
+        try {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            auto existing = sh.items.find(hash);
+            if (sh.items.end() != existing) {
+                sh.lru.erase(existing->second.lru_pos);
+                sh.items.erase(existing);
+            }
+            while (sh.items.size() >= sh.max_entries) {
+                sh.items.erase(sh.lru.back());
+                sh.lru.pop_back();
+                evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+            sh.lru.push_front(hash);
+            auto& it = sh.items[hash];
+            it.payload.assign(json_in, json_in_len);
+            it.has_result = nullptr != json_out;
+            if (it.has_result) {
+                it.result.assign(json_out, json_out_len);
+            }
+            it.expires_at = 0 != ttl_millis ? now_millis() + ttl_millis : 0;
+            it.lru_pos = sh.lru.begin();
+        } catch (...) {
+            // not cached
+        }
+    }
+
+    sl::json::value to_json() {
+        size_t size = 0;
+        for (auto& sh : shards) {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            size += sh.items.size();
+        }
+        return {
+            { "name", call_name },
+            { "hits", static_cast<int64_t>(hits.load(std::memory_order_relaxed)) },
+            { "misses", static_cast<int64_t>(misses.load(std::memory_order_relaxed)) },
+            { "evictions", static_cast<int64_t>(evictions.load(std::memory_order_relaxed)) },
+            { "size", static_cast<int64_t>(size) }
+        };
+    }
+
+private:
+    // must be called under shard mutex, expired item is evicted
+    item* find_live(shard& sh, uint64_t hash, const char* json_in, size_t json_in_len) STATICLIB_NOEXCEPT {
+        auto it = sh.items.find(hash);
+        if (sh.items.end() == it || !payload_equal(it->second, json_in, json_in_len)) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto& it_val = it->second;
+        if (0 != it_val.expires_at && it_val.expires_at <= now_millis()) {
+            sh.lru.erase(it_val.lru_pos);
+            sh.items.erase(it);
+            evictions.fetch_add(1, std::memory_order_relaxed);
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return std::addressof(it_val);
+    }
+
+    static size_t shards_for(uint32_t max_entries) STATICLIB_NOEXCEPT {
+        if (0 == max_entries) {
+            return 1;
+        }
+        return max_entries < shards_count ? static_cast<size_t>(max_entries) : shards_count;
+    }
+
+    static bool payload_equal(const item& it, const char* json_in, size_t json_in_len) STATICLIB_NOEXCEPT {
+        return it.payload.length() == json_in_len &&
+                0 == std::memcmp(it.payload.data(), json_in, json_in_len);
+    }
+
+    static uint64_t now_millis() STATICLIB_NOEXCEPT {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+    }
+};
+
+// caches are listed in 'get_wiltoncall_stats' while their calls are registered
+void register_cache(std::weak_ptr<result_cache> cache);
+
+} // namespace
+}
+
+#endif /* WILTON_CALL_RESULT_CACHE_HPP */
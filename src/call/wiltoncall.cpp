@@ -7,11 +7,14 @@
 
 #include "wilton/wiltoncall.h"
 
+#include <algorithm>
 #include <atomic>
-#include <map>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <memory>
-#include <mutex>
 #include <utility>
+#include <vector>
 
 #include "staticlib/config.hpp"
 #include "staticlib/tinydir.hpp"
@@ -21,73 +24,386 @@
 #include "wilton/support/misc.hpp"
 #include "wilton/support/registrar.hpp"
 
+#include "alloc/allocator.hpp"
+#include "alloc/alloc_tracking.hpp"
+#include "call/call_registry.hpp"
+#include "call/call_stats.hpp"
+#include "call/result_cache.hpp"
 #include "call/wiltoncall_internal.hpp"
+#include "json/cbor_transcoder.hpp"
+#include "trace/trace_recorder.hpp"
 
 namespace { // anonymous
 
-const size_t max_registry_entries_count = 1 << 16;
+std::shared_ptr<wilton::call::call_registry> shared_registry() {
+    static auto reg = std::make_shared<wilton::call::call_registry>();
+    return reg;
+}
 
-using cb_ctx_type = void*;
-using cb_fun_type = char* (*)(void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len);
+const size_t max_error_data_len = 1024;
 
-class registry {
-    std::mutex mutex;
-    std::map<std::string, std::pair<cb_ctx_type, cb_fun_type>> map;
+/**
+ * Last error of 'wiltoncall_coded' on this thread, message
+ * is formatted only when it is requested
+ */
+class error_slot {
+    int code = WILTONCALL_OK;
+    const char* param_name = "";
+    int64_t value = 0;
+    char call_name[64];
+    size_t call_name_len = 0;
+    char* callback_err = nullptr;
 
 public:
-    registry() { }
-
-    registry(const registry& other) = delete;
-
-    registry& operator=(const registry& other) = delete;
-
-    void put(const std::string& name, cb_ctx_type cb_ctx, cb_fun_type cb_fun) {
-        if (name.empty()) throw wilton::support::exception(TRACEMSG(
-                "Invalid empty 'wiltoncall' name specified"));
-        if (nullptr == cb_fun) throw wilton::support::exception(TRACEMSG(
-                "Invalid null 'wiltoncall' function specified for name: [" + name + "]"));
-        std::lock_guard<std::mutex> guard{mutex};
-        if (map.size() >= max_registry_entries_count) throw wilton::support::exception(TRACEMSG(
-                "'wiltoncall' registry size exceeded, max size: [" + sl::support::to_string(max_registry_entries_count) + "]"));
-        if (0 == map.count(name)) {
-            map.insert(std::make_pair(name, std::make_pair(cb_ctx, cb_fun)));
-        } else {
-            throw wilton::support::exception(TRACEMSG(
-                    "Invalid duplicate 'wiltoncall' name specified: [" + name + "]"));
-        }
+    error_slot() {
+        call_name[0] = '\0';
     }
 
-    std::pair<cb_ctx_type, cb_fun_type> get(const std::string& name) {
-        if (name.empty()) throw wilton::support::exception(TRACEMSG(
-                "Invalid empty 'wiltoncall' name specified"));
-        std::lock_guard<std::mutex> guard{mutex};
-        auto it = map.find(name);
-        if (map.end() == it) {
-            throw wilton::support::exception(TRACEMSG(
-                    "Invalid unknown 'wiltoncall' name specified: [" + name + "]"));
+    error_slot(const error_slot&) = delete;
+
+    error_slot& operator=(const error_slot&) = delete;
+
+    ~error_slot() STATICLIB_NOEXCEPT {
+        wilton_free(callback_err);
+    }
+
+    int set(int err_code, const char* name, size_t name_len, const char* param = "",
+            int64_t param_value = 0, char* err = nullptr) STATICLIB_NOEXCEPT {
+        wilton_free(callback_err);
+        code = err_code;
+        param_name = param;
+        value = param_value;
+        call_name_len = std::min(name_len, sizeof(call_name) - 1);
+        if (call_name_len > 0) {
+            std::memcpy(call_name, name, call_name_len);
         }
-        return it->second;
+        call_name[call_name_len] = '\0';
+        // slot outlives the arenas opened on this thread
+        callback_err = wilton::alloc::detach(err, nullptr != err ? std::strlen(err) + 1 : 0);
+        return code;
     }
 
-    void remove(const std::string& name) {
-        if (name.empty()) throw wilton::support::exception(TRACEMSG(
-                "Invalid empty 'wiltoncall' name specified"));
-        std::lock_guard<std::mutex> guard{mutex};
-        auto res = map.erase(name);
-        if (0 == res) {
-            throw wilton::support::exception(TRACEMSG(
-                    "Invalid unknown 'wiltoncall' name specified: [" + name + "]"));
+    int get_code() const STATICLIB_NOEXCEPT {
+        return code;
+    }
+
+    int format(char* buf, size_t buf_len) const STATICLIB_NOEXCEPT {
+        switch (code) {
+        case WILTONCALL_OK:
+            return std::snprintf(buf, buf_len, "%s", "");
+        case WILTONCALL_ERROR_INVALID_PARAMETER:
+            return std::snprintf(buf, buf_len, "Invalid '%s' parameter specified: [%lld]",
+                    param_name, static_cast<long long> (value));
+        case WILTONCALL_ERROR_UNKNOWN_NAME:
+            return std::snprintf(buf, buf_len, "Invalid unknown 'wiltoncall' name specified: [%s]", call_name);
+        case WILTONCALL_ERROR_REMOVED_NAME:
+            return std::snprintf(buf, buf_len, "Invalid removed 'wiltoncall' name specified: [%s]", call_name);
+        case WILTONCALL_ERROR_CALLBACK:
+            return std::snprintf(buf, buf_len, "'wiltoncall' error for name: [%s], error: [%s]",
+                    call_name, nullptr != callback_err ? callback_err : "");
+        case WILTONCALL_ERROR_INVALID_RESULT:
+            return std::snprintf(buf, buf_len, "Invalid result length value returned: [%lld], name: [%s]",
+                    static_cast<long long> (value), call_name);
+        case WILTONCALL_ERROR_PAYLOAD_FORMAT:
+            return std::snprintf(buf, buf_len, "Payload transcoding error for name: [%s], error: [%s]",
+                    call_name, nullptr != callback_err ? callback_err : "");
+        default:
+            return std::snprintf(buf, buf_len, "'wiltoncall' error, code: [%d]", code);
         }
     }
 };
 
-std::shared_ptr<registry> shared_registry() {
-    static auto reg = std::make_shared<registry>();
-    return reg;
+error_slot& thread_error_slot() STATICLIB_NOEXCEPT {
+    thread_local error_slot slot;
+    return slot;
+}
+
+std::string truncated_data(const char* json_in, int json_in_len) {
+    auto len = static_cast<uint32_t> (json_in_len);
+    if (len <= max_error_data_len) {
+        return std::string(json_in, len);
+    }
+    return std::string(json_in, max_error_data_len) + "...(" + sl::support::to_string(len) + " bytes total)";
+}
+
+wilton::call::call_stats* entry_stats(wilton::call::call_entry& en) STATICLIB_NOEXCEPT {
+    auto st = en.stats.load(std::memory_order_relaxed);
+    if (nullptr == st) {
+        try {
+            st = wilton::call::stats_for(en.name);
+            en.stats.store(st, std::memory_order_relaxed);
+        } catch (...) {
+            // not recorded
+        }
+    }
+    return st;
+}
+
+uint16_t entry_origin(wilton::call::call_entry& en) STATICLIB_NOEXCEPT {
+    auto origin = en.alloc_origin.load(std::memory_order_relaxed);
+    if (0 == origin) {
+        origin = wilton::alloc::origin_for(en.name);
+        en.alloc_origin.store(origin, std::memory_order_relaxed);
+    }
+    return origin;
+}
+
+const size_t into_small_buffer_len = 256;
+
+// into-only call invoked through the allocating API, callback
+// is called again when the result does not fit the small buffer
+char* call_into_alloc(wilton::call::call_entry& en, const char* json_in, int json_in_len,
+        char** json_out, int* json_out_len) STATICLIB_NOEXCEPT {
+    char small[into_small_buffer_len];
+    int required = 0;
+    auto err = en.into_fun(en.cb_ctx, json_in, json_in_len, small, static_cast<int> (sizeof(small)),
+            std::addressof(required));
+    if (nullptr != err || required <= 0) {
+        *json_out_len = required;
+        return err;
+    }
+    auto out = wilton_alloc(required);
+    if (nullptr == out) {
+        return wilton::support::alloc_copy(TRACEMSG("Output buffer allocation error," +
+                " size: [" + sl::support::to_string(required) + "], name: [" + en.name + "]"));
+    }
+    if (static_cast<size_t> (required) <= sizeof(small)) {
+        std::memcpy(out, small, static_cast<size_t> (required));
+    } else {
+        int written = 0;
+        err = en.into_fun(en.cb_ctx, json_in, json_in_len, out, required, std::addressof(written));
+        if (nullptr == err && (written < 0 || written > required)) {
+            err = wilton::support::alloc_copy(TRACEMSG("Result length changed on repeated call," +
+                    " expected: [" + sl::support::to_string(required) + "]," +
+                    " actual: [" + sl::support::to_string(written) + "], name: [" + en.name + "]"));
+        }
+        if (nullptr != err) {
+            wilton_free(out);
+            return err;
+        }
+        required = written;
+    }
+    *json_out = out;
+    *json_out_len = required;
+    return nullptr;
+}
+
+// allocating callback invoked through the 'into' API
+char* call_alloc_into(wilton::call::call_entry& en, const char* json_in, int json_in_len,
+        char* out_buf, int out_buf_cap, int* json_out_len) STATICLIB_NOEXCEPT {
+    char* out = nullptr;
+    int out_len = 0;
+    auto err = en.cb_fun(en.cb_ctx, json_in, json_in_len, std::addressof(out), std::addressof(out_len));
+    if (nullptr == err && nullptr != out) {
+        if (sl::support::is_uint32(out_len) && out_len <= out_buf_cap) {
+            std::memcpy(out_buf, out, static_cast<size_t> (out_len));
+        }
+        *json_out_len = out_len;
+    }
+    wilton_free(out);
+    return err;
+}
+
+char* call_callback(wilton::call::call_entry& en, const char* json_in, int json_in_len,
+        bool into_mode, char* out_buf, int out_buf_cap, char** json_out, int* json_out_len) STATICLIB_NOEXCEPT {
+    if (into_mode) {
+        if (nullptr != en.into_fun) {
+            return en.into_fun(en.cb_ctx, json_in, json_in_len, out_buf, out_buf_cap, json_out_len);
+        }
+        return call_alloc_into(en, json_in, json_in_len, out_buf, out_buf_cap, json_out_len);
+    }
+    if (nullptr != en.cb_fun) {
+        return en.cb_fun(en.cb_ctx, json_in, json_in_len, json_out, json_out_len);
+    }
+    return call_into_alloc(en, json_in, json_in_len, json_out, json_out_len);
+}
+
+// callback error is passed to 'err_out', invalid result length to 'json_out_len',
+// in 'into_mode' result is written to 'out_buf' when it fits into 'out_buf_cap'
+int invoke_nothrow(wilton::call::call_entry& en, const char* json_in, int json_in_len,
+        char** json_out, int* json_out_len, char** err_out,
+        bool into_mode = false, char* out_buf = nullptr, int out_buf_cap = 0) STATICLIB_NOEXCEPT {
+    if (en.removed.load(std::memory_order_relaxed)) {
+        return WILTONCALL_ERROR_REMOVED_NAME;
+    }
+    wilton::trace::scope traced{"wiltoncall", en.name};
+    wilton::alloc::origin_scope origin_scoped{wilton::alloc::tracking_enabled() ? entry_origin(en) : uint16_t(0)};
+    wilton::call::call_stats* st = nullptr;
+    uint64_t start = 0;
+    if (wilton::call::stats_enabled()) {
+        st = entry_stats(en);
+        start = wilton::call::stats_now_nanos();
+    }
+    int code = WILTONCALL_OK;
+    char* out = nullptr;
+    int out_len = 0;
+    uint64_t hash = 0;
+    char* err = nullptr;
+    auto in_len = static_cast<uint32_t> (json_in_len);
+    bool cached = false;
+    if (nullptr != en.cache.get()) {
+        hash = wilton::call::result_cache::payload_hash(json_in, in_len);
+        cached = into_mode ?
+                en.cache->get_into(hash, json_in, in_len, out_buf, static_cast<uint32_t> (out_buf_cap),
+                        std::addressof(out_len)) :
+                en.cache->get(hash, json_in, in_len, std::addressof(out), std::addressof(out_len));
+    }
+    if (!cached) {
+        err = call_callback(en, json_in, json_in_len, into_mode, out_buf, out_buf_cap,
+                std::addressof(out), std::addressof(out_len));
+        if (nullptr != en.cache.get() && nullptr == err && sl::support::is_uint32(out_len)) {
+            if (!into_mode) {
+                en.cache->put(hash, json_in, in_len, out, static_cast<uint32_t> (out_len));
+            } else if (out_len <= out_buf_cap) {
+                en.cache->put(hash, json_in, in_len, out_len > 0 ? out_buf : nullptr,
+                        static_cast<uint32_t> (out_len));
+            }
+        }
+    }
+    // null result of allocating callbacks keeps the previous meaning of any length
+    bool check_len = into_mode || nullptr == en.cb_fun || nullptr != out;
+    if (nullptr != err) {
+        *err_out = err;
+        code = WILTONCALL_ERROR_CALLBACK;
+    } else if (check_len && !sl::support::is_uint32(out_len)) {
+        wilton_free(out);
+        *json_out = nullptr;
+        *json_out_len = out_len;
+        code = WILTONCALL_ERROR_INVALID_RESULT;
+    } else if (into_mode) {
+        *json_out = out_buf;
+        *json_out_len = out_len;
+    } else if (nullptr != out) {
+        *json_out = out;
+        *json_out_len = out_len;
+    } else {
+        *json_out = nullptr;
+        *json_out_len = 0;
+    }
+    if (nullptr != st) {
+        auto out_bytes = WILTONCALL_OK == code ? static_cast<uint32_t> (*json_out_len) : 0;
+        st->record(WILTONCALL_OK != code, in_len, out_bytes,
+                wilton::call::stats_now_nanos() - start);
+    }
+    return code;
+}
+
+char* transcode_nothrow(int format_in, const char* data, int data_len, int format_out,
+        char** data_out, int* data_out_len) STATICLIB_NOEXCEPT {
+    try {
+        auto span = wilton::json::transcode_payload(format_in,
+                sl::io::make_span(data, static_cast<size_t> (data_len)), format_out);
+        *data_out = span.data();
+        *data_out_len = static_cast<int> (span.size());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what()));
+    }
+}
+
+// payloads are transcoded only when the caller formats differ from the call one,
+// transcoding error is passed to 'err_out'
+int invoke_format_nothrow(wilton::call::call_entry& en, const char* data_in, int data_in_len,
+        char** data_out, int* data_out_len, char** err_out,
+        bool into_mode, char* out_buf, int out_buf_cap, int format_in, int format_out) STATICLIB_NOEXCEPT {
+    if (format_in == en.payload_format && format_out == en.payload_format) {
+        return invoke_nothrow(en, data_in, data_in_len, data_out, data_out_len, err_out,
+                into_mode, out_buf, out_buf_cap);
+    }
+    char* in = nullptr;
+    int in_len = 0;
+    if (format_in != en.payload_format) {
+        auto err = transcode_nothrow(format_in, data_in, data_in_len, en.payload_format,
+                std::addressof(in), std::addressof(in_len));
+        if (nullptr != err) {
+            *err_out = err;
+            return WILTONCALL_ERROR_PAYLOAD_FORMAT;
+        }
+        data_in = in;
+        data_in_len = in_len;
+    }
+    auto deferred = sl::support::defer([in]() STATICLIB_NOEXCEPT {
+        wilton_free(in);
+    });
+    if (format_out == en.payload_format) {
+        return invoke_nothrow(en, data_in, data_in_len, data_out, data_out_len, err_out,
+                into_mode, out_buf, out_buf_cap);
+    }
+    // result in call format is always allocated to be transcoded
+    char* out = nullptr;
+    int out_len = 0;
+    auto code = invoke_nothrow(en, data_in, data_in_len, std::addressof(out), std::addressof(out_len), err_out);
+    if (WILTONCALL_OK != code || nullptr == out) {
+        *data_out = into_mode ? out_buf : nullptr;
+        *data_out_len = out_len;
+        return code;
+    }
+    char* conv = nullptr;
+    int conv_len = 0;
+    auto err = transcode_nothrow(en.payload_format, out, out_len, format_out,
+            std::addressof(conv), std::addressof(conv_len));
+    wilton_free(out);
+    if (nullptr != err) {
+        *err_out = err;
+        return WILTONCALL_ERROR_PAYLOAD_FORMAT;
+    }
+    if (into_mode) {
+        if (conv_len <= out_buf_cap) {
+            std::memcpy(out_buf, conv, static_cast<size_t> (conv_len));
+        }
+        wilton_free(conv);
+        conv = out_buf;
+    }
+    *data_out = conv;
+    *data_out_len = conv_len;
+    return WILTONCALL_OK;
+}
+
+void invoke_entry(wilton::call::call_entry& en, const char* json_in, int json_in_len,
+        char** json_out, int* json_out_len,
+        bool into_mode = false, char* out_buf = nullptr, int out_buf_cap = 0,
+        int format_in = WILTONCALL_FORMAT_JSON, int format_out = WILTONCALL_FORMAT_JSON) {
+    char* err = nullptr;
+    auto code = invoke_format_nothrow(en, json_in, json_in_len, json_out, json_out_len, std::addressof(err),
+            into_mode, out_buf, out_buf_cap, format_in, format_out);
+    switch (code) {
+    case WILTONCALL_OK:
+        return;
+    case WILTONCALL_ERROR_CALLBACK:
+        wilton::support::throw_wilton_error(err, TRACEMSG(err));
+        break;
+    case WILTONCALL_ERROR_PAYLOAD_FORMAT: {
+        auto msg = std::string(err);
+        wilton_free(err);
+        throw wilton::support::exception(TRACEMSG(msg + "\nPayload transcoding error, name: [" + en.name + "]"));
+    }
+    case WILTONCALL_ERROR_REMOVED_NAME:
+        throw wilton::support::exception(TRACEMSG(
+                "Invalid removed 'wiltoncall' name specified: [" + en.name + "]"));
+    case WILTONCALL_ERROR_INVALID_RESULT:
+        throw wilton::support::exception(TRACEMSG(
+                "Invalid result length value returned: [" + sl::support::to_string(*json_out_len) + "]"));
+    default:
+        throw wilton::support::exception(TRACEMSG(
+                "'wiltoncall' error, code: [" + sl::support::to_string(code) + "]"));
+    }
 }
 
 } // namespace
 
+struct wilton_CallHandle {
+private:
+    std::shared_ptr<wilton::call::call_entry> entry;
+
+public:
+    wilton_CallHandle(std::shared_ptr<wilton::call::call_entry>&& entry) :
+    entry(std::move(entry)) { }
+
+    wilton::call::call_entry& impl() {
+        return *entry;
+    }
+};
+
 namespace wilton {
 namespace internal {
 
@@ -96,6 +412,11 @@ std::shared_ptr<sl::json::value> shared_wiltoncall_config(const std::string& cf_
     return cf;
 }
 
+const std::string& shared_wiltoncall_config_bytes() {
+    static const std::string bytes = shared_wiltoncall_config()->dumps();
+    return bytes;
+}
+
 } // namespace
 }
 
@@ -113,13 +434,66 @@ char* wiltoncall_init(const char* config_json, int config_json_len) {
         }
         // set static config
         auto config_json_str = std::string(config_json, static_cast<uint16_t> (config_json_len));
-        wilton::internal::shared_wiltoncall_config(config_json_str);
+        auto conf = wilton::internal::shared_wiltoncall_config(config_json_str);
+        // serialized once, config is immutable after init
+        wilton::internal::shared_wiltoncall_config_bytes();
+
+        // allocator
+        auto& alloc_json = conf->getattr("allocator");
+        if (sl::json::type::object == alloc_json.json_type()) {
+            auto& engine_json = alloc_json.getattr("engine");
+            if (sl::json::type::nullt != engine_json.json_type()) {
+                wilton::alloc::set_engine(engine_json.as_string_nonempty_or_throw("allocator.engine"));
+            }
+            auto& threshold_json = alloc_json.getattr("mmapThreshold");
+            if (sl::json::type::nullt != threshold_json.json_type()) {
+                wilton::alloc::set_mmap_threshold(threshold_json.as_uint32_or_throw("allocator.mmapThreshold"));
+            }
+            auto& huge_pages_json = alloc_json.getattr("hugePages");
+            if (sl::json::type::nullt != huge_pages_json.json_type()) {
+                wilton::alloc::set_huge_pages_enabled(huge_pages_json.as_bool_or_throw("allocator.hugePages"));
+            }
+            auto& tracking_json = alloc_json.getattr("tracking");
+            if (sl::json::type::nullt != tracking_json.json_type()) {
+                wilton::alloc::set_tracking_enabled(tracking_json.as_bool_or_throw("allocator.tracking"));
+            }
+        }
+
+        // stats
+        auto& stats_json = conf->getattr("callStats");
+        if (sl::json::type::object == stats_json.json_type()) {
+            auto& enabled_json = stats_json.getattr("enabled");
+            if (sl::json::type::nullt != enabled_json.json_type()) {
+                wilton::call::stats_enable(enabled_json.as_bool_or_throw("callStats.enabled"));
+            }
+        }
+
+        // trace
+        auto& trace_json = conf->getattr("trace");
+        if (sl::json::type::object == trace_json.json_type()) {
+            auto& enabled_json = trace_json.getattr("enabled");
+            if (sl::json::type::nullt != enabled_json.json_type()) {
+                wilton::trace::set_enabled(enabled_json.as_bool_or_throw("trace.enabled"));
+            }
+        }
+
+        // alloc
+        wilton::support::register_wiltoncall_into("get_alloc_stats", wilton::alloc::get_alloc_stats);
+        wilton::support::register_wiltoncall("get_alloc_tracking", wilton::alloc::get_alloc_tracking);
+
+        // call
+        wilton::support::register_wiltoncall_into("get_wiltoncall_stats", wilton::call::get_wiltoncall_stats);
 
         // dyload
         wilton::support::register_wiltoncall("dyload_shared_library", wilton::dyload::dyload_shared_library);
         // misc
-        wilton::support::register_wiltoncall("get_wiltoncall_config", wilton::misc::get_wiltoncall_config);
+        // config is immutable after init
+        wilton::support::register_wiltoncall_cacheable("get_wiltoncall_config", wilton::misc::get_wiltoncall_config, 0, 16);
         wilton::support::register_wiltoncall("stdin_readline", wilton::misc::stdin_readline);
+        wilton::support::register_wiltoncall("get_engine_stats", wilton::misc::get_engine_stats);
+        // trace
+        wilton::support::register_wiltoncall("trace_set_enabled", wilton::trace::trace_set_enabled);
+        wilton::support::register_wiltoncall_into("trace_dump", wilton::trace::trace_dump);
 
         return nullptr;
     } catch (const std::exception& e) {
@@ -142,36 +516,243 @@ char* wiltoncall(const char* call_name, int call_name_len, const char* json_in,
     try {
         uint16_t call_name_len_u16 = static_cast<uint16_t> (call_name_len);
         call_name_str = std::string(call_name, call_name_len_u16);
-        // get entry
-        auto reg = shared_registry();
+        // get entry, registry pointer is copied once to not touch its counter on every call
+        static auto reg = shared_registry();
         auto en = reg->get(call_name_str);
         // invoke function
-        cb_ctx_type cb_ctx = en.first;
-        cb_fun_type cb_fun = en.second;
-        char* out = nullptr;
-        int out_len = 0;
-        auto err = cb_fun(cb_ctx, json_in, json_in_len, std::addressof(out), std::addressof(out_len));
-        // check error
-        if (nullptr != err) {
-            wilton::support::throw_wilton_error(err, TRACEMSG(err));
+        invoke_entry(*en, json_in, json_in_len, json_out, json_out_len);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + 
+                "\n'wiltoncall' error for name: [" + call_name_str + "]," +
+                " data: [" + truncated_data(json_in, json_in_len) + "]"));
+    }
+}
+
+char* wiltoncall_format(const char* call_name, int call_name_len, int format_in, const char* data_in,
+        int data_in_len, int format_out, char** data_out, int* data_out_len) /* noexcept */ {
+    if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
+    if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'call_name_len' parameter specified: [" + sl::support::to_string(call_name_len) + "]"));
+    if (!wilton::json::is_known_format(format_in)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'format_in' parameter specified: [" + sl::support::to_string(format_in) + "]"));
+    if (nullptr == data_in) return wilton::support::alloc_copy(TRACEMSG("Null 'data_in' parameter specified"));
+    if (!sl::support::is_uint32_positive(data_in_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'data_in_len' parameter specified: [" + sl::support::to_string(data_in_len) + "]"));
+    if (!wilton::json::is_known_format(format_out)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'format_out' parameter specified: [" + sl::support::to_string(format_out) + "]"));
+    if (nullptr == data_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out' parameter specified"));
+    if (nullptr == data_out_len) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out_len' parameter specified"));
+    auto call_name_str = std::string();
+    try {
+        call_name_str = std::string(call_name, static_cast<uint16_t> (call_name_len));
+        static auto reg = shared_registry();
+        auto en = reg->get(call_name_str);
+        invoke_entry(*en, data_in, data_in_len, data_out, data_out_len,
+                false, nullptr, 0, format_in, format_out);
+        return nullptr;
+    } catch (const std::exception& e) {
+        // binary input is not included
+        auto data = WILTONCALL_FORMAT_JSON == format_in ? truncated_data(data_in, data_in_len) :
+                "(" + sl::support::to_string(data_in_len) + " bytes)";
+        return wilton::support::alloc_copy(TRACEMSG(e.what() +
+                "\n'wiltoncall' error for name: [" + call_name_str + "]," +
+                " data: [" + data + "]"));
+    }
+}
+
+int wiltoncall_coded(const char* call_name, int call_name_len, const char* json_in, int json_in_len,
+        char** json_out, int* json_out_len) /* noexcept */ {
+    auto& slot = thread_error_slot();
+    if (nullptr == call_name) return slot.set(WILTONCALL_ERROR_INVALID_PARAMETER, "", 0, "call_name");
+    if (!sl::support::is_uint16_positive(call_name_len)) return slot.set(WILTONCALL_ERROR_INVALID_PARAMETER,
+            "", 0, "call_name_len", call_name_len);
+    if (nullptr == json_in) return slot.set(WILTONCALL_ERROR_INVALID_PARAMETER, call_name, call_name_len, "json_in");
+    if (!sl::support::is_uint32_positive(json_in_len)) return slot.set(WILTONCALL_ERROR_INVALID_PARAMETER,
+            call_name, call_name_len, "json_in_len", json_in_len);
+    if (nullptr == json_out) return slot.set(WILTONCALL_ERROR_INVALID_PARAMETER, call_name, call_name_len, "json_out");
+    if (nullptr == json_out_len) return slot.set(WILTONCALL_ERROR_INVALID_PARAMETER, call_name, call_name_len, "json_out_len");
+    // lookup key buffer is reused to not allocate for long names
+    thread_local std::string key;
+    static auto reg = shared_registry();
+    auto en = std::shared_ptr<wilton::call::call_entry>();
+    try {
+        key.assign(call_name, static_cast<uint16_t> (call_name_len));
+        en = reg->find(key);
+    } catch (...) {
+        // bad alloc, reported as unknown name
+    }
+    if (nullptr == en.get()) {
+        return slot.set(WILTONCALL_ERROR_UNKNOWN_NAME, call_name, call_name_len);
+    }
+    char* err = nullptr;
+    auto code = invoke_format_nothrow(*en, json_in, json_in_len, json_out, json_out_len, std::addressof(err),
+            false, nullptr, 0, WILTONCALL_FORMAT_JSON, WILTONCALL_FORMAT_JSON);
+    if (WILTONCALL_OK != code) {
+        return slot.set(code, call_name, call_name_len, "", *json_out_len, err);
+    }
+    return slot.set(WILTONCALL_OK, "", 0);
+}
+
+int wiltoncall_last_error(char* buf, int buf_len) /* noexcept */ {
+    auto& slot = thread_error_slot();
+    if (nullptr != buf && sl::support::is_uint32_positive(buf_len)) {
+        slot.format(buf, static_cast<uint32_t> (buf_len));
+    }
+    return slot.get_code();
+}
+
+char* wiltoncall_resolve(const char* call_name, int call_name_len,
+        wilton_CallHandle** handle_out) /* noexcept */ {
+    if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
+    if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'call_name_len' parameter specified: [" + sl::support::to_string(call_name_len) + "]"));
+    if (nullptr == handle_out) return wilton::support::alloc_copy(TRACEMSG("Null 'handle_out' parameter specified"));
+    try {
+        auto call_name_str = std::string(call_name, static_cast<uint16_t> (call_name_len));
+        auto reg = shared_registry();
+        auto en = reg->get(call_name_str);
+        wilton_CallHandle* handle_ptr = new wilton_CallHandle(std::move(en));
+        *handle_out = handle_ptr;
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wiltoncall_invoke(wilton_CallHandle* handle, const char* json_in, int json_in_len,
+        char** json_out, int* json_out_len) /* noexcept */ {
+    if (nullptr == handle) return wilton::support::alloc_copy(TRACEMSG("Null 'handle' parameter specified"));
+    if (nullptr == json_in) return wilton::support::alloc_copy(TRACEMSG("Null 'json_in' parameter specified"));
+    if (!sl::support::is_uint32_positive(json_in_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'json_in_len' parameter specified: [" + sl::support::to_string(json_in_len) + "]"));
+    if (nullptr == json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'json_out' parameter specified"));
+    if (nullptr == json_out_len) return wilton::support::alloc_copy(TRACEMSG("Null 'json_out_len' parameter specified"));
+    try {
+        invoke_entry(handle->impl(), json_in, json_in_len, json_out, json_out_len);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() +
+                "\n'wiltoncall' error for name: [" + handle->impl().name + "]," +
+                " data: [" + truncated_data(json_in, json_in_len) + "]"));
+    }
+}
+
+char* wiltoncall_release(wilton_CallHandle* handle) /* noexcept */ {
+    if (nullptr == handle) return wilton::support::alloc_copy(TRACEMSG("Null 'handle' parameter specified"));
+    delete handle;
+    return nullptr;
+}
+
+char* wiltoncall_batch(const char** call_names, const int* call_names_lens,
+        const char** jsons_in, const int* jsons_in_lens, int items_count,
+        char** batch_out, int* batch_out_len, int* offsets_out, int* errors_out) /* noexcept */ {
+    if (nullptr == call_names) return wilton::support::alloc_copy(TRACEMSG("Null 'call_names' parameter specified"));
+    if (nullptr == call_names_lens) return wilton::support::alloc_copy(TRACEMSG("Null 'call_names_lens' parameter specified"));
+    if (nullptr == jsons_in) return wilton::support::alloc_copy(TRACEMSG("Null 'jsons_in' parameter specified"));
+    if (nullptr == jsons_in_lens) return wilton::support::alloc_copy(TRACEMSG("Null 'jsons_in_lens' parameter specified"));
+    if (!sl::support::is_uint16_positive(items_count)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'items_count' parameter specified: [" + sl::support::to_string(items_count) + "]"));
+    if (nullptr == batch_out) return wilton::support::alloc_copy(TRACEMSG("Null 'batch_out' parameter specified"));
+    if (nullptr == batch_out_len) return wilton::support::alloc_copy(TRACEMSG("Null 'batch_out_len' parameter specified"));
+    if (nullptr == offsets_out) return wilton::support::alloc_copy(TRACEMSG("Null 'offsets_out' parameter specified"));
+    if (nullptr == errors_out) return wilton::support::alloc_copy(TRACEMSG("Null 'errors_out' parameter specified"));
+    try {
+        uint16_t count = static_cast<uint16_t> (items_count);
+        // resolve all entries at once
+        static auto reg = shared_registry();
+        auto entries = std::vector<std::shared_ptr<wilton::call::call_entry>>();
+        reg->find_all(call_names, call_names_lens, count, entries);
+
+        // invoke functions, results and errors are collected to be copied into a single buffer
+        auto results = std::vector<sl::io::span<char>>();
+        results.reserve(count);
+        auto deferred = sl::support::defer([&results]() STATICLIB_NOEXCEPT {
+            for (auto& sp : results) {
+                wilton_free(sp.data());
+            }
+        });
+        uint64_t total_len = 0;
+        for (size_t i = 0; i < count; i++) {
+            char* out = nullptr;
+            int out_len = 0;
+            errors_out[i] = 0;
+            try {
+                if (nullptr == entries[i].get()) {
+                    auto name = nullptr != call_names[i] && sl::support::is_uint16_positive(call_names_lens[i]) ?
+                            std::string(call_names[i], static_cast<uint16_t> (call_names_lens[i])) : std::string();
+                    throw wilton::support::exception(TRACEMSG(
+                            "Invalid unknown 'wiltoncall' name specified: [" + name + "]"));
+                }
+                if (nullptr == jsons_in[i]) throw wilton::support::exception(TRACEMSG(
+                        "Null 'json_in' specified"));
+                if (!sl::support::is_uint32_positive(jsons_in_lens[i])) throw wilton::support::exception(TRACEMSG(
+                        "Invalid 'json_in_len' specified: [" + sl::support::to_string(jsons_in_lens[i]) + "]"));
+                invoke_entry(*entries[i], jsons_in[i], jsons_in_lens[i], std::addressof(out), std::addressof(out_len));
+            } catch (const std::exception& e) {
+                out = wilton::support::alloc_copy(TRACEMSG(e.what() +
+                        "\n'wiltoncall' batch error for item: [" + sl::support::to_string(i) + "]"));
+                out_len = static_cast<int> (std::strlen(out));
+                errors_out[i] = 1;
+            }
+            results.emplace_back(out, static_cast<size_t> (out_len));
+            total_len += static_cast<uint32_t> (out_len);
         }
-        // check result
-        if (nullptr != out) {
-            if (!sl::support::is_uint32(out_len)) {
-                throw wilton::support::exception(TRACEMSG(
-                        "Invalid result length value returned: [" + sl::support::to_string(out_len) + "]"));
+
+        // copy results
+        if (!sl::support::is_uint32(total_len) || total_len > static_cast<uint64_t> (std::numeric_limits<int>::max())) {
+            throw wilton::support::exception(TRACEMSG(
+                    "Invalid batch result length: [" + sl::support::to_string(total_len) + "]"));
+        }
+        char* buf = nullptr;
+        if (total_len > 0) {
+            buf = wilton_alloc(static_cast<int> (total_len));
+            if (nullptr == buf) throw wilton::support::exception(TRACEMSG(
+                    "Batch result allocation error, length: [" + sl::support::to_string(total_len) + "]"));
+        }
+        int offset = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            auto& sp = results[i];
+            offsets_out[i] = offset;
+            if (sp.size() > 0) {
+                std::memcpy(buf + offset, sp.data(), sp.size());
+                offset += static_cast<int> (sp.size());
             }
-            *json_out = out;
-            *json_out_len = out_len;
-        } else {
-            *json_out = nullptr;
-            *json_out_len = 0;
         }
+        offsets_out[count] = offset;
+        *batch_out = buf;
+        *batch_out_len = offset;
         return nullptr;
     } catch (const std::exception& e) {
-        return wilton::support::alloc_copy(TRACEMSG(e.what() + 
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\n'wiltoncall' batch error"));
+    }
+}
+
+char* wiltoncall_into(const char* call_name, int call_name_len, const char* json_in, int json_in_len,
+        char* out_buf, int out_buf_cap, int* json_out_len) /* noexcept */ {
+    if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
+    if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'call_name_len' parameter specified: [" + sl::support::to_string(call_name_len) + "]"));
+    if (nullptr == json_in) return wilton::support::alloc_copy(TRACEMSG("Null 'json_in' parameter specified"));
+    if (!sl::support::is_uint32_positive(json_in_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'json_in_len' parameter specified: [" + sl::support::to_string(json_in_len) + "]"));
+    if (!sl::support::is_uint32(out_buf_cap)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'out_buf_cap' parameter specified: [" + sl::support::to_string(out_buf_cap) + "]"));
+    if (nullptr == out_buf && out_buf_cap > 0) return wilton::support::alloc_copy(TRACEMSG("Null 'out_buf' parameter specified"));
+    if (nullptr == json_out_len) return wilton::support::alloc_copy(TRACEMSG("Null 'json_out_len' parameter specified"));
+    auto call_name_str = std::string();
+    try {
+        call_name_str = std::string(call_name, static_cast<uint16_t> (call_name_len));
+        static auto reg = shared_registry();
+        auto en = reg->get(call_name_str);
+        char* out = nullptr;
+        invoke_entry(*en, json_in, json_in_len, std::addressof(out), json_out_len,
+                true, out_buf, out_buf_cap);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() +
                 "\n'wiltoncall' error for name: [" + call_name_str + "]," +
-                " data: [" + std::string(json_in, static_cast<uint32_t> (json_in_len)) + "]"));
+                " data: [" + truncated_data(json_in, json_in_len) + "]"));
     }
 }
 
@@ -192,6 +773,85 @@ char* wiltoncall_register(const char* call_name, int call_name_len, void* call_c
     }
 }
 
+char* wiltoncall_register_cacheable(const char* call_name, int call_name_len, void* call_ctx,
+        char* (*call_cb)
+        (void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len),
+        int ttl_millis, int max_entries) /* noexcept */ {
+    if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
+    if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'call_name_len' parameter specified: [" + sl::support::to_string(call_name_len) + "]"));
+    if (nullptr == call_cb) return wilton::support::alloc_copy(TRACEMSG("Null 'call_cb' parameter specified"));
+    if (!sl::support::is_uint32(ttl_millis)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'ttl_millis' parameter specified: [" + sl::support::to_string(ttl_millis) + "]"));
+    if (!sl::support::is_uint32_positive(max_entries)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'max_entries' parameter specified: [" + sl::support::to_string(max_entries) + "]"));
+    try {
+        auto call_name_str = std::string(call_name, static_cast<uint16_t> (call_name_len));
+        auto cache = std::make_shared<wilton::call::result_cache>(call_name_str,
+                static_cast<uint32_t> (ttl_millis), static_cast<uint32_t> (max_entries));
+        auto reg = shared_registry();
+        reg->put(call_name_str, call_ctx, call_cb, cache);
+        wilton::call::register_cache(cache);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wiltoncall_register_into(const char* call_name, int call_name_len, void* call_ctx,
+        char* (*call_cb)
+        (void* call_ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len),
+        char* (*into_cb)
+        (void* call_ctx, const char* json_in, int json_in_len, char* out_buf, int out_buf_cap, int* json_out_len)) /* noexcept */ {
+    if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
+    if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'call_name_len' parameter specified: [" + sl::support::to_string(call_name_len) + "]"));
+    if (nullptr == into_cb) return wilton::support::alloc_copy(TRACEMSG("Null 'into_cb' parameter specified"));
+    try {
+        auto call_name_str = std::string(call_name, static_cast<uint16_t> (call_name_len));
+        auto reg = shared_registry();
+        reg->put(call_name_str, call_ctx, call_cb, std::shared_ptr<wilton::call::result_cache>(), into_cb);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wiltoncall_register_format(const char* call_name, int call_name_len, void* call_ctx,
+        char* (*call_cb)
+        (void* call_ctx, const char* data_in, int data_in_len, char** data_out, int* data_out_len),
+        int payload_format) /* noexcept */ {
+    if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
+    if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'call_name_len' parameter specified: [" + sl::support::to_string(call_name_len) + "]"));
+    if (nullptr == call_cb) return wilton::support::alloc_copy(TRACEMSG("Null 'call_cb' parameter specified"));
+    if (!wilton::json::is_known_format(payload_format)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'payload_format' parameter specified: [" + sl::support::to_string(payload_format) + "]"));
+    try {
+        auto call_name_str = std::string(call_name, static_cast<uint16_t> (call_name_len));
+        auto reg = shared_registry();
+        reg->put(call_name_str, call_ctx, call_cb, std::shared_ptr<wilton::call::result_cache>(),
+                nullptr, payload_format);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wiltoncall_transcode(int format_in, const char* data_in, int data_in_len, int format_out,
+        char** data_out, int* data_out_len) /* noexcept */ {
+    if (!wilton::json::is_known_format(format_in)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'format_in' parameter specified: [" + sl::support::to_string(format_in) + "]"));
+    if (nullptr == data_in) return wilton::support::alloc_copy(TRACEMSG("Null 'data_in' parameter specified"));
+    if (!sl::support::is_uint32_positive(data_in_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'data_in_len' parameter specified: [" + sl::support::to_string(data_in_len) + "]"));
+    if (!wilton::json::is_known_format(format_out)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'format_out' parameter specified: [" + sl::support::to_string(format_out) + "]"));
+    if (nullptr == data_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out' parameter specified"));
+    if (nullptr == data_out_len) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out_len' parameter specified"));
+    return transcode_nothrow(format_in, data_in, data_in_len, format_out, data_out, data_out_len);
+}
+
 char* wiltoncall_remove(const char* call_name, int call_name_len) {
     if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
     if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
@@ -221,14 +881,33 @@ char* wiltoncall_runscript(const char* script_engine_name, int script_engine_nam
     if (nullptr == json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'json_out' parameter specified"));
     if (nullptr == json_out_len) return wilton::support::alloc_copy(TRACEMSG("Null 'json_out_len' parameter specified"));
     try {
-        auto engine = std::ref(sl::utils::empty_string());
-        auto specified_engine = std::string(script_engine_name, static_cast<uint16_t> (script_engine_name_len));
-        engine = !specified_engine.empty() ? specified_engine : default_engine;
-        auto callname = "runscript_" + engine.get();
-        
+        // engine call handle is cached per thread and is re-resolved
+        // only when another engine is requested or the call was removed
+        static const std::string prefix = "runscript_";
+        thread_local std::unique_ptr<wilton_CallHandle, void(*)(wilton_CallHandle*)> cached{nullptr,
+                [](wilton_CallHandle* ha) STATICLIB_NOEXCEPT {
+                    wiltoncall_release(ha);
+                }};
+        const char* engine = script_engine_name;
+        size_t engine_len = static_cast<uint16_t> (script_engine_name_len);
+        if (0 == engine_len) {
+            engine = default_engine.data();
+            engine_len = default_engine.length();
+        }
+        if (nullptr == cached.get() || cached->impl().removed.load(std::memory_order_relaxed) ||
+                0 != cached->impl().name.compare(prefix.length(), std::string::npos, engine, engine_len)) {
+            auto callname = prefix + std::string(engine, engine_len);
+            wilton_CallHandle* handle = nullptr;
+            auto err_resolve = wiltoncall_resolve(callname.c_str(), static_cast<int>(callname.length()),
+                    std::addressof(handle));
+            if (nullptr != err_resolve) {
+                wilton::support::throw_wilton_error(err_resolve, TRACEMSG(err_resolve));
+            }
+            cached.reset(handle);
+        }
+
         // call engine
-        auto err = wiltoncall(callname.c_str(), static_cast<int>(callname.length()),
-                json_in, json_in_len, json_out, json_out_len);
+        auto err = wiltoncall_invoke(cached.get(), json_in, json_in_len, json_out, json_out_len);
         if (nullptr != err) {
             wilton::support::throw_wilton_error(err, TRACEMSG(err));
         }
@@ -0,0 +1,192 @@
+/*
+ * File:   wiltoncall_async.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 1:05 PM
+ */
+
+#include "wilton/wiltoncall.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/alloc_copy.hpp"
+#include "wilton/support/exception.hpp"
+
+#include "call/work_stealing_pool.hpp"
+#include "call/wiltoncall_internal.hpp"
+
+namespace { // anonymous
+
+class async_result {
+public:
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool ready = false;
+    char* err = nullptr;
+    char* out = nullptr;
+    int out_len = 0;
+
+    ~async_result() STATICLIB_NOEXCEPT {
+        wilton_free(err);
+        wilton_free(out);
+    }
+};
+
+size_t pool_threads_count() {
+    auto cf = wilton::internal::shared_wiltoncall_config();
+    auto& pool_json = cf->getattr("asyncPool");
+    if (sl::json::type::object == pool_json.json_type()) {
+        auto& tc = pool_json.getattr("threadsCount");
+        if (sl::json::type::nullt != tc.json_type()) {
+            return tc.as_uint16_positive_or_throw("asyncPool.threadsCount");
+        }
+    }
+    auto hc = std::thread::hardware_concurrency();
+    return hc > 0 ? hc : 2;
+}
+
+std::shared_ptr<wilton::call::work_stealing_pool> shared_pool() {
+    static auto pool = std::make_shared<wilton::call::work_stealing_pool>(pool_threads_count(),
+            [] () STATICLIB_NOEXCEPT {
+                // thread-local script engines of the worker
+                auto tid = sl::support::to_string_any(std::this_thread::get_id());
+                auto err = wilton_clean_tls(tid.c_str(), static_cast<int>(tid.length()));
+                wilton_free(err);
+            });
+    return pool;
+}
+
+} // namespace
+
+struct wilton_CallFuture {
+private:
+    std::shared_ptr<async_result> result;
+
+public:
+    wilton_CallFuture(std::shared_ptr<async_result> result) :
+    result(std::move(result)) { }
+
+    async_result& impl() {
+        return *result;
+    }
+};
+
+char* wiltoncall_async(const char* call_name, int call_name_len, const char* json_in, int json_in_len,
+        void* cb_ctx, void (*cb)(void* cb_ctx, char* err, char* json_out, int json_out_len),
+        wilton_CallFuture** future_out) /* noexcept */ {
+    if (nullptr == call_name) return wilton::support::alloc_copy(TRACEMSG("Null 'call_name' parameter specified"));
+    if (!sl::support::is_uint16_positive(call_name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'call_name_len' parameter specified: [" + sl::support::to_string(call_name_len) + "]"));
+    if (nullptr == json_in) return wilton::support::alloc_copy(TRACEMSG("Null 'json_in' parameter specified"));
+    if (!sl::support::is_uint32_positive(json_in_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'json_in_len' parameter specified: [" + sl::support::to_string(json_in_len) + "]"));
+    if (nullptr != cb && nullptr != future_out) return wilton::support::alloc_copy(TRACEMSG(
+            "Only one of 'cb' and 'future_out' parameters can be specified"));
+    try {
+        // resolve name before submitting to report unknown names to caller
+        wilton_CallHandle* handle = nullptr;
+        auto err_resolve = wiltoncall_resolve(call_name, call_name_len, std::addressof(handle));
+        if (nullptr != err_resolve) {
+            wilton::support::throw_wilton_error(err_resolve, TRACEMSG(err_resolve));
+        }
+        auto handle_shared = std::shared_ptr<wilton_CallHandle>(handle, [](wilton_CallHandle* ha) STATICLIB_NOEXCEPT {
+            wilton_free(wiltoncall_release(ha));
+        });
+        auto data = std::make_shared<std::string>(json_in, static_cast<uint32_t> (json_in_len));
+        auto result = std::shared_ptr<async_result>();
+        if (nullptr != future_out) {
+            result = std::make_shared<async_result>();
+        }
+
+        // submit
+        auto pool = shared_pool();
+        pool->submit([handle_shared, data, result, cb_ctx, cb] {
+            char* out = nullptr;
+            int out_len = 0;
+            char* err = wiltoncall_invoke(handle_shared.get(), data->data(), static_cast<int>(data->length()),
+                    std::addressof(out), std::addressof(out_len));
+            if (nullptr != cb) {
+                cb(cb_ctx, err, out, out_len);
+            } else if (nullptr != result.get()) {
+                {
+                    std::lock_guard<std::mutex> guard{result->mutex};
+                    result->err = err;
+                    result->out = out;
+                    result->out_len = out_len;
+                    result->ready = true;
+                }
+                result->cv.notify_all();
+            } else {
+                wilton_free(err);
+                wilton_free(out);
+            }
+        });
+
+        if (nullptr != future_out) {
+            wilton_CallFuture* future_ptr = new wilton_CallFuture(std::move(result));
+            *future_out = future_ptr;
+        }
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wiltoncall_future_wait(wilton_CallFuture* future, int timeout_millis, int* ready_out) /* noexcept */ {
+    if (nullptr == future) return wilton::support::alloc_copy(TRACEMSG("Null 'future' parameter specified"));
+    if (nullptr == ready_out) return wilton::support::alloc_copy(TRACEMSG("Null 'ready_out' parameter specified"));
+    try {
+        auto& res = future->impl();
+        std::unique_lock<std::mutex> lock{res.mutex};
+        if (timeout_millis < 0) {
+            res.cv.wait(lock, [&res] {
+                return res.ready;
+            });
+        } else if (timeout_millis > 0) {
+            res.cv.wait_for(lock, std::chrono::milliseconds(timeout_millis), [&res] {
+                return res.ready;
+            });
+        }
+        *ready_out = res.ready ? 1 : 0;
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wiltoncall_future_get(wilton_CallFuture* future, char** json_out, int* json_out_len) /* noexcept */ {
+    if (nullptr == future) return wilton::support::alloc_copy(TRACEMSG("Null 'future' parameter specified"));
+    if (nullptr == json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'json_out' parameter specified"));
+    if (nullptr == json_out_len) return wilton::support::alloc_copy(TRACEMSG("Null 'json_out_len' parameter specified"));
+    try {
+        auto& res = future->impl();
+        std::lock_guard<std::mutex> guard{res.mutex};
+        if (!res.ready) throw wilton::support::exception(TRACEMSG(
+                "Asynchronous 'wiltoncall' is not yet completed"));
+        // ownership of result is passed to caller
+        char* err = res.err;
+        res.err = nullptr;
+        *json_out = res.out;
+        *json_out_len = res.out_len;
+        res.out = nullptr;
+        res.out_len = 0;
+        return err;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wiltoncall_future_destroy(wilton_CallFuture* future) /* noexcept */ {
+    if (nullptr == future) return wilton::support::alloc_copy(TRACEMSG("Null 'future' parameter specified"));
+    delete future;
+    return nullptr;
+}
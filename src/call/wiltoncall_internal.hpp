@@ -23,15 +23,35 @@
 #include "wilton/support/buffer.hpp"
 #include "wilton/support/exception.hpp"
 #include "wilton/support/handle_registry.hpp"
+#include "wilton/support/json_cursor.hpp"
+#include "wilton/support/json_view.hpp"
 #include "wilton/support/payload_handle_registry.hpp"
 
 namespace wilton {
 
+// alloc
+
+namespace alloc {
+
+support::buffer get_alloc_stats(sl::io::span<const char> data);
+
+support::buffer get_alloc_tracking(const support::json_view& data);
+
+} // namespace
+
+// call
+
+namespace call {
+
+support::buffer get_wiltoncall_stats(sl::io::span<const char> data);
+
+} // namespace
+
 // dyload
 
 namespace dyload {
 
-support::buffer dyload_shared_library(sl::io::span<const char> data);
+support::buffer dyload_shared_library(support::json_cursor& data);
 
 } // namespace
 
@@ -41,16 +61,32 @@ namespace misc {
 support::buffer get_wiltoncall_config(sl::io::span<const char> data);
 
 support::buffer stdin_readline(sl::io::span<const char> data);
+
+support::buffer get_engine_stats(sl::io::span<const char> data);
     
 } // namespace
 
 
+// trace
+
+namespace trace {
+
+support::buffer trace_set_enabled(sl::io::span<const char> data);
+
+support::buffer trace_dump(sl::io::span<const char> data);
+
+} // namespace
+
 // internal api
 
 namespace internal {
 
 std::shared_ptr<sl::json::value> shared_wiltoncall_config(const std::string& cf_json = "");
 
+const std::string& shared_wiltoncall_config_bytes();
+
+sl::json::value collect_engine_stats();
+
 } // namespace
 
 } // namespace
@@ -0,0 +1,139 @@
+/*
+ * File:   wiltoncall_stats.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 2:55 PM
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+#include "call/call_stats.hpp"
+#include "call/result_cache.hpp"
+#include "call/wiltoncall_internal.hpp"
+
+namespace wilton {
+namespace call {
+
+namespace { // anonymous
+
+std::atomic<bool> stats_enabled_flag{false};
+
+class stats_registry {
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<call_stats>> map;
+
+public:
+    call_stats* get(const std::string& name) {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = map.find(name);
+        if (map.end() == it) {
+            auto pa = map.insert(std::make_pair(name, std::unique_ptr<call_stats>(new call_stats(name))));
+            it = pa.first;
+        }
+        return it->second.get();
+    }
+
+    std::vector<sl::json::value> to_json(bool reset) {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto res = std::vector<sl::json::value>();
+        for (auto& pa : map) {
+            res.emplace_back(pa.second->to_json());
+            if (reset) {
+                pa.second->reset();
+            }
+        }
+        return res;
+    }
+};
+
+std::shared_ptr<stats_registry> shared_stats_registry() {
+    static auto reg = std::make_shared<stats_registry>();
+    return reg;
+}
+
+class caches_registry {
+    std::mutex mutex;
+    std::vector<std::weak_ptr<result_cache>> caches;
+
+public:
+    void put(std::weak_ptr<result_cache> cache) {
+        std::lock_guard<std::mutex> guard{mutex};
+        caches.erase(std::remove_if(caches.begin(), caches.end(), [](const std::weak_ptr<result_cache>& ca) {
+            return ca.expired();
+        }), caches.end());
+        caches.emplace_back(std::move(cache));
+    }
+
+    std::vector<sl::json::value> to_json() {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto res = std::vector<sl::json::value>();
+        for (auto& weak : caches) {
+            auto ca = weak.lock();
+            if (nullptr != ca.get()) {
+                res.emplace_back(ca->to_json());
+            }
+        }
+        return res;
+    }
+};
+
+std::shared_ptr<caches_registry> shared_caches_registry() {
+    static auto reg = std::make_shared<caches_registry>();
+    return reg;
+}
+
+} // namespace
+
+bool stats_enabled() STATICLIB_NOEXCEPT {
+    return stats_enabled_flag.load(std::memory_order_relaxed);
+}
+
+void stats_enable(bool enabled) STATICLIB_NOEXCEPT {
+    stats_enabled_flag.store(enabled, std::memory_order_relaxed);
+}
+
+call_stats* stats_for(const std::string& call_name) {
+    static auto reg = shared_stats_registry();
+    return reg->get(call_name);
+}
+
+void register_cache(std::weak_ptr<result_cache> cache) {
+    auto reg = shared_caches_registry();
+    reg->put(std::move(cache));
+}
+
+support::buffer get_wiltoncall_stats(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    bool reset = false;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("reset" == name) {
+            reset = fi.as_bool_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    // collect
+    auto reg = shared_stats_registry();
+    auto calls = reg->to_json(reset);
+    auto caches_reg = shared_caches_registry();
+    auto caches = caches_reg->to_json();
+    return support::make_json_result({
+        { "enabled", stats_enabled() },
+        { "calls", std::move(calls) },
+        { "caches", std::move(caches) }
+    });
+}
+
+} // namespace
+}
@@ -0,0 +1,162 @@
+/*
+ * File:   work_stealing_pool.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 12:40 PM
+ */
+
+#ifndef WILTON_CALL_WORK_STEALING_POOL_HPP
+#define WILTON_CALL_WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+namespace wilton {
+namespace call {
+
+/**
+ * Fixed size thread pool with a task queue per worker, workers take
+ * their own tasks from the back of the queue and steal tasks of
+ * other workers from the front
+ */
+class work_stealing_pool {
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> threads;
+    std::function<void()> thread_exit_hook;
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> next_queue;
+    std::atomic<bool> stopping;
+
+public:
+    work_stealing_pool(size_t threads_count, std::function<void()> thread_exit_hook) :
+    thread_exit_hook(std::move(thread_exit_hook)),
+    pending(0),
+    next_queue(0),
+    stopping(false) {
+        for (size_t i = 0; i < threads_count; i++) {
+            queues.emplace_back(new worker_queue());
+        }
+        for (size_t i = 0; i < threads_count; i++) {
+            threads.emplace_back([this, i] {
+                this->run_worker(i);
+            });
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    // pending tasks are run before the workers exit
+    ~work_stealing_pool() STATICLIB_NOEXCEPT {
+        {
+            std::lock_guard<std::mutex> guard{sleep_mutex};
+            stopping.store(true);
+        }
+        sleep_cv.notify_all();
+        for (auto& th : threads) {
+            th.join();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        // tasks submitted from worker threads stay on their queues
+        auto idx = worker_index();
+        if (idx >= queues.size()) {
+            idx = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        }
+        auto& qu = *queues[idx];
+        // counted before it can be taken, so 'pending' never wraps below zero
+        pending.fetch_add(1);
+        try {
+            std::lock_guard<std::mutex> guard{qu.mutex};
+            qu.tasks.emplace_back(std::move(task));
+        } catch (...) {
+            pending.fetch_sub(1);
+            throw;
+        }
+        {
+            std::lock_guard<std::mutex> guard{sleep_mutex};
+        }
+        sleep_cv.notify_one();
+    }
+
+    size_t size() const {
+        return threads.size();
+    }
+
+private:
+    size_t& worker_index() {
+        thread_local size_t idx = static_cast<size_t>(-1);
+        return idx;
+    }
+
+    bool take_task(size_t idx, std::function<void()>& task) {
+        {
+            auto& own = *queues[idx];
+            std::lock_guard<std::mutex> guard{own.mutex};
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); i++) {
+            auto& other = *queues[(idx + i) % queues.size()];
+            std::lock_guard<std::mutex> guard{other.mutex};
+            if (!other.tasks.empty()) {
+                task = std::move(other.tasks.front());
+                other.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run_worker(size_t idx) {
+        worker_index() = idx;
+        for (;;) {
+            auto task = std::function<void()>();
+            if (take_task(idx, task)) {
+                pending.fetch_sub(1);
+                try {
+                    task();
+                } catch (...) {
+                    // tasks must report their own errors
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{sleep_mutex};
+            sleep_cv.wait(lock, [this] {
+                return stopping.load() || pending.load() > 0;
+            });
+            if (stopping.load() && 0 == pending.load()) {
+                break;
+            }
+        }
+        if (thread_exit_hook) {
+            thread_exit_hook();
+        }
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_CALL_WORK_STEALING_POOL_HPP */
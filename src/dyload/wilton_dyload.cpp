@@ -21,6 +21,8 @@
 #include "wilton/support/alloc_copy.hpp"
 #include "wilton/support/exception.hpp"
 
+#include "trace/trace_recorder.hpp"
+
 #ifdef STATICLIB_WINDOWS
 #include "dyload/dyload_windows.hpp"
 #else // !STATICLIB_WINDOWS
@@ -66,6 +68,7 @@ char* wilton_dyload(const char* name, int name_len,
                 auto exedir_raw = sl::utils::strip_filename(exepath);
                 return sl::tinydir::normalize_path(exedir_raw);
             } ();
+            wilton::trace::scope traced{"dyload", name_str};
             std::function<char*()> initializer = wilton::dyload::dyload_platform(directory_str, name_str);
             auto err = initializer();
             if (nullptr != err) {
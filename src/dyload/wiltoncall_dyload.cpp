@@ -14,30 +14,27 @@
 
 #include "wilton/wilton.h"
 
+#include "wilton/support/json_schema.hpp"
+
 #include "call/wiltoncall_internal.hpp"
 
 namespace wilton {
 namespace dyload {
 
-support::buffer dyload_shared_library(sl::io::span<const char> data) {
+support::buffer dyload_shared_library(support::json_cursor& data) {
     // json parse
-    auto json = sl::json::load(data);
-    auto rname = std::ref(sl::utils::empty_string());
-    auto rdirectory = std::ref(sl::utils::empty_string());
-    for (const sl::json::field& fi : json.as_object()) {
-        auto& name = fi.name();
-        if ("name" == name) {
-            rname = fi.as_string_nonempty_or_throw(name);
-        } else if ("directory" == name) {
-            rdirectory = fi.as_string_nonempty_or_throw(name);
-        } else {
-            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+    static const auto schema = support::make_json_schema(
+            support::required_field("name", support::field_kind::string_nonempty),
+            support::optional_field("directory", support::field_kind::string_nonempty));
+    auto name = std::string();
+    auto directory = std::string();
+    schema.read_object(data, [&](size_t idx, const std::string& key) {
+        switch (idx) {
+        case 0: name = data.read_string_nonempty(key); break;
+        case 1: directory = data.read_string_nonempty(key); break;
         }
-    }
-    if (rname.get().empty()) throw support::exception(TRACEMSG(
-            "Required parameter 'path' not specified"));
-    const std::string& name = rname.get();
-    const std::string& directory = rdirectory.get();
+    });
+    data.finish();
     // call wilton
     auto err = wilton_dyload(name.c_str(), static_cast<int>(name.length()),
             directory.c_str(), static_cast<int>(directory.length()));
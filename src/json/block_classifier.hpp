@@ -0,0 +1,146 @@
+/*
+ * File:   block_classifier.hpp
+ * Author: alex
+ *
+ * Created on October 22, 2026, 3:40 PM
+ */
+
+#ifndef WILTON_JSON_BLOCK_CLASSIFIER_HPP
+#define WILTON_JSON_BLOCK_CLASSIFIER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "staticlib/config.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define WILTON_JSON_X86_SIMD
+#include <immintrin.h>
+#endif // __GNUC__ && x86 && __SSE2__
+
+namespace wilton {
+namespace json {
+
+const size_t block_size = 64;
+
+// bit per byte of a 64-byte block
+struct block_masks {
+    uint64_t backslash;
+    uint64_t quote;
+    uint64_t op;
+    uint64_t ws;
+    uint64_t control;
+};
+
+using classify_fun_type = void(*)(const char* block, block_masks& masks);
+
+// reference classifier, used on CPUs without SIMD support
+inline void classify_scalar(const char* block, block_masks& masks) STATICLIB_NOEXCEPT {
+    masks = block_masks();
+    for (size_t i = 0; i < block_size; i++) {
+        auto ch = static_cast<unsigned char>(block[i]);
+        auto bit = static_cast<uint64_t>(1) << i;
+        switch (ch) {
+        case '\\': masks.backslash |= bit; break;
+        case '"': masks.quote |= bit; break;
+        case '{': case '}': case '[': case ']': case ':': case ',': masks.op |= bit; break;
+        case ' ': case '\t': case '\n': case '\r': masks.ws |= bit; break;
+        default: break;
+        }
+        if (ch < 0x20) {
+            masks.control |= bit;
+        }
+    }
+}
+
+#ifdef WILTON_JSON_X86_SIMD
+
+inline uint64_t movemask_sse2(__m128i vec) STATICLIB_NOEXCEPT {
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(vec)) & 0xFFFF);
+}
+
+inline void classify_sse2(const char* block, block_masks& masks) STATICLIB_NOEXCEPT {
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i quote = _mm_set1_epi8('"');
+    // '[' | 0x20 == '{' and ']' | 0x20 == '}'
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+    masks = block_masks();
+    for (size_t i = 0; i < block_size / 16; i++) {
+        auto vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        auto shift = i * 16;
+        auto lowered = _mm_or_si128(vec, lower);
+        auto op = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(lowered, open), _mm_cmpeq_epi8(lowered, close)),
+                _mm_or_si128(_mm_cmpeq_epi8(vec, colon), _mm_cmpeq_epi8(vec, comma)));
+        auto ws = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(vec, space), _mm_cmpeq_epi8(vec, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(vec, lf), _mm_cmpeq_epi8(vec, cr)));
+        auto control = _mm_cmpeq_epi8(_mm_max_epu8(vec, control_max), control_max);
+        masks.backslash |= movemask_sse2(_mm_cmpeq_epi8(vec, backslash)) << shift;
+        masks.quote |= movemask_sse2(_mm_cmpeq_epi8(vec, quote)) << shift;
+        masks.op |= movemask_sse2(op) << shift;
+        masks.ws |= movemask_sse2(ws) << shift;
+        masks.control |= movemask_sse2(control) << shift;
+    }
+}
+
+__attribute__((target("avx2")))
+inline uint64_t movemask_avx2(__m256i vec) STATICLIB_NOEXCEPT {
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(vec)));
+}
+
+// must only be called when 'avx2_supported()' returns true
+__attribute__((target("avx2")))
+inline void classify_avx2(const char* block, block_masks& masks) STATICLIB_NOEXCEPT {
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i lower = _mm256_set1_epi8(0x20);
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i control_max = _mm256_set1_epi8(0x1F);
+    masks = block_masks();
+    for (size_t i = 0; i < block_size / 32; i++) {
+        auto vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i * 32));
+        auto shift = i * 32;
+        auto lowered = _mm256_or_si256(vec, lower);
+        auto op = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(lowered, open), _mm256_cmpeq_epi8(lowered, close)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(vec, colon), _mm256_cmpeq_epi8(vec, comma)));
+        auto ws = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(vec, space), _mm256_cmpeq_epi8(vec, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(vec, lf), _mm256_cmpeq_epi8(vec, cr)));
+        auto control = _mm256_cmpeq_epi8(_mm256_max_epu8(vec, control_max), control_max);
+        masks.backslash |= movemask_avx2(_mm256_cmpeq_epi8(vec, backslash)) << shift;
+        masks.quote |= movemask_avx2(_mm256_cmpeq_epi8(vec, quote)) << shift;
+        masks.op |= movemask_avx2(op) << shift;
+        masks.ws |= movemask_avx2(ws) << shift;
+        masks.control |= movemask_avx2(control) << shift;
+    }
+}
+
+inline bool avx2_supported() STATICLIB_NOEXCEPT {
+    __builtin_cpu_init();
+    return 0 != __builtin_cpu_supports("avx2");
+}
+
+#endif // WILTON_JSON_X86_SIMD
+
+} // namespace
+}
+
+#endif /* WILTON_JSON_BLOCK_CLASSIFIER_HPP */
@@ -0,0 +1,550 @@
+/*
+ * File:   cbor_transcoder.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 2:20 PM
+ */
+
+#include "json/cbor_transcoder.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/wiltoncall.h"
+
+#include "wilton/support/alloc_copy.hpp"
+#include "wilton/support/buffer.hpp"
+#include "wilton/support/exception.hpp"
+#include "wilton/support/json_cursor.hpp"
+
+namespace wilton {
+namespace json {
+
+namespace { // anonymous
+
+const size_t max_depth = 1024;
+
+const uint8_t major_uint = 0;
+const uint8_t major_negint = 1;
+const uint8_t major_bytes = 2;
+const uint8_t major_text = 3;
+const uint8_t major_array = 4;
+const uint8_t major_map = 5;
+const uint8_t major_tag = 6;
+const uint8_t major_simple = 7;
+
+const uint8_t ai_indefinite = 31;
+const uint8_t cbor_break = 0xFF;
+
+void write_head(std::string& out, uint8_t major, uint64_t val) {
+    auto mt = static_cast<char>(major << 5);
+    if (val < 24) {
+        out.push_back(static_cast<char>(mt | static_cast<char>(val)));
+    } else if (val <= 0xFF) {
+        out.push_back(static_cast<char>(mt | 24));
+        out.push_back(static_cast<char>(val));
+    } else if (val <= 0xFFFF) {
+        out.push_back(static_cast<char>(mt | 25));
+        for (int shift = 8; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(val >> shift));
+        }
+    } else if (val <= 0xFFFFFFFF) {
+        out.push_back(static_cast<char>(mt | 26));
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(val >> shift));
+        }
+    } else {
+        out.push_back(static_cast<char>(mt | 27));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(val >> shift));
+        }
+    }
+}
+
+void write_int(std::string& out, int64_t val) {
+    if (val >= 0) {
+        write_head(out, major_uint, static_cast<uint64_t>(val));
+    } else {
+        // -1 - n without overflow on min value
+        write_head(out, major_negint, static_cast<uint64_t>(-(val + 1)));
+    }
+}
+
+// strict UTF-8, overlong forms, surrogates and code points
+// above U+10FFFF are rejected
+bool is_valid_utf8(const char* data, size_t len) {
+    auto it = reinterpret_cast<const unsigned char*>(data);
+    auto end = it + len;
+    while (it < end) {
+        auto ch = *it++;
+        if (ch < 0x80) {
+            continue;
+        }
+        size_t count = 0;
+        uint32_t cp = 0;
+        uint32_t min = 0;
+        if (0xC0 == (ch & 0xE0)) {
+            count = 1;
+            cp = ch & 0x1F;
+            min = 0x80;
+        } else if (0xE0 == (ch & 0xF0)) {
+            count = 2;
+            cp = ch & 0x0F;
+            min = 0x800;
+        } else if (0xF0 == (ch & 0xF8)) {
+            count = 3;
+            cp = ch & 0x07;
+            min = 0x10000;
+        } else {
+            return false;
+        }
+        if (static_cast<size_t>(end - it) < count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (0x80 != (it[i] & 0xC0)) {
+                return false;
+            }
+            cp = (cp << 6) | (it[i] & 0x3F);
+        }
+        it += count;
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_text(std::string& out, const std::string& str, size_t position) {
+    if (!is_valid_utf8(str.data(), str.length())) {
+        throw support::exception(TRACEMSG("JSON parse error: Invalid UTF-8 string," +
+                " position: [" + sl::support::to_string(position) + "]"));
+    }
+    write_head(out, major_text, str.length());
+    out.append(str);
+}
+
+void write_double(std::string& out, double val) {
+    // conversion of out of range values to float is undefined
+    bool single_range = std::isnan(val) || std::isinf(val) || std::fabs(val) <= FLT_MAX;
+    auto single = std::isnan(val) ? std::numeric_limits<float>::quiet_NaN() :
+            single_range ? static_cast<float>(val) : 0.0f;
+    if (single_range && (static_cast<double>(single) == val || std::isnan(val))) {
+        uint32_t bits = 0;
+        std::memcpy(std::addressof(bits), std::addressof(single), sizeof(bits));
+        out.push_back(static_cast<char>(0xFA));
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(bits >> shift));
+        }
+    } else {
+        uint64_t bits = 0;
+        std::memcpy(std::addressof(bits), std::addressof(val), sizeof(bits));
+        out.push_back(static_cast<char>(0xFB));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(bits >> shift));
+        }
+    }
+}
+
+void encode_value(support::json_cursor& cur, std::string& out, std::string& str, size_t depth) {
+    if (depth > max_depth) {
+        throw support::exception(TRACEMSG("JSON nesting depth exceeded, max depth: [" +
+                sl::support::to_string(max_depth) + "]"));
+    }
+    switch (cur.peek()) {
+    case sl::json::type::object:
+        cur.enter_object();
+        out.push_back(static_cast<char>((major_map << 5) | ai_indefinite));
+        while (cur.next_field()) {
+            write_text(out, cur.key(), cur.position());
+            encode_value(cur, out, str, depth + 1);
+        }
+        out.push_back(static_cast<char>(cbor_break));
+        break;
+    case sl::json::type::array:
+        cur.enter_array();
+        out.push_back(static_cast<char>((major_array << 5) | ai_indefinite));
+        while (cur.next_element()) {
+            encode_value(cur, out, str, depth + 1);
+        }
+        out.push_back(static_cast<char>(cbor_break));
+        break;
+    case sl::json::type::string:
+        str = cur.read_string();
+        write_text(out, str, cur.position());
+        break;
+    case sl::json::type::integer: {
+        // integers out of int64 range are encoded as reals,
+        // other invalid tokens are rejected by the strict 'read_double'
+        auto start = cur.position();
+        try {
+            write_int(out, cur.read_int64());
+        } catch (const support::exception&) {
+            if (cur.position() != start) {
+                throw;
+            }
+            write_double(out, cur.read_double());
+        }
+        break;
+    }
+    case sl::json::type::real:
+        write_double(out, cur.read_double());
+        break;
+    case sl::json::type::boolean:
+        out.push_back(static_cast<char>(cur.read_bool() ? 0xF5 : 0xF4));
+        break;
+    case sl::json::type::nullt:
+        if (!cur.read_null()) {
+            throw support::exception(TRACEMSG("JSON parse error: Invalid value," +
+                    " position: [" + sl::support::to_string(cur.position()) + "]"));
+        }
+        out.push_back(static_cast<char>(0xF6));
+        break;
+    default:
+        throw support::exception(TRACEMSG("JSON parse error: Invalid value," +
+                " position: [" + sl::support::to_string(cur.position()) + "]"));
+    }
+}
+
+void write_json_string(std::string& out, const char* data, size_t len) {
+    static const char* hex = "0123456789abcdef";
+    out.push_back('"');
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++) {
+        auto ch = static_cast<unsigned char>(data[i]);
+        if ('"' != ch && '\\' != ch && ch >= 0x20) {
+            continue;
+        }
+        out.append(data + start, i - start);
+        start = i + 1;
+        out.push_back('\\');
+        switch (ch) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '\b': out.push_back('b'); break;
+        case '\f': out.push_back('f'); break;
+        case '\n': out.push_back('n'); break;
+        case '\r': out.push_back('r'); break;
+        case '\t': out.push_back('t'); break;
+        default:
+            out.append("u00");
+            out.push_back(hex[ch >> 4]);
+            out.push_back(hex[ch & 0xF]);
+        }
+    }
+    out.append(data + start, len - start);
+    out.push_back('"');
+}
+
+void write_json_double(std::string& out, double val) {
+    if (std::isnan(val) || std::isinf(val)) {
+        out.append("null");
+        return;
+    }
+    // shortest of the round-tripping precisions
+    char buf[32];
+    int len = std::snprintf(buf, sizeof(buf), "%.15g", val);
+    if (std::strtod(buf, nullptr) != val) {
+        len = std::snprintf(buf, sizeof(buf), "%.17g", val);
+    }
+    out.append(buf, static_cast<size_t>(len));
+    // kept as real when read back
+    if (nullptr == std::strpbrk(buf, ".eE")) {
+        out.append(".0");
+    }
+}
+
+class cbor_decoder {
+    const unsigned char* const begin;
+    const unsigned char* const end;
+    const unsigned char* pos;
+    std::string& out;
+    std::string chunks;
+
+public:
+    cbor_decoder(sl::io::span<const char> data, std::string& out) :
+    begin(reinterpret_cast<const unsigned char*>(data.data())),
+    end(reinterpret_cast<const unsigned char*>(data.data()) + data.size()),
+    pos(reinterpret_cast<const unsigned char*>(data.data())),
+    out(out) { }
+
+    cbor_decoder(const cbor_decoder&) = delete;
+
+    cbor_decoder& operator=(const cbor_decoder&) = delete;
+
+    void decode() {
+        decode_item(0);
+        if (pos != end) {
+            throw_error("Unexpected trailing data");
+        }
+    }
+
+private:
+    uint8_t next_byte() {
+        if (pos >= end) {
+            throw_error("Unexpected end of input");
+        }
+        return *pos++;
+    }
+
+    uint64_t read_be(size_t count) {
+        if (static_cast<size_t>(end - pos) < count) {
+            throw_error("Unexpected end of input");
+        }
+        uint64_t res = 0;
+        for (size_t i = 0; i < count; i++) {
+            res = (res << 8) | pos[i];
+        }
+        pos += count;
+        return res;
+    }
+
+    uint64_t read_arg(uint8_t ai) {
+        if (ai < 24) {
+            return ai;
+        }
+        switch (ai) {
+        case 24: return read_be(1);
+        case 25: return read_be(2);
+        case 26: return read_be(4);
+        case 27: return read_be(8);
+        default: throw_error("Invalid additional info: [" + sl::support::to_string(static_cast<int>(ai)) + "]");
+        }
+        return 0;
+    }
+
+    bool at_break() {
+        if (pos >= end) {
+            throw_error("Unexpected end of input");
+        }
+        if (cbor_break == *pos) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    sl::io::span<const char> read_text(uint8_t ai) {
+        auto start = pos;
+        auto res = read_string_data(major_text, ai);
+        if (!is_valid_utf8(res.data(), res.size())) {
+            pos = start;
+            throw_error("Invalid UTF-8 text string");
+        }
+        return res;
+    }
+
+    // definite string is returned in place, chunks of indefinite one are joined
+    sl::io::span<const char> read_string_data(uint8_t major, uint8_t ai) {
+        if (ai_indefinite != ai) {
+            auto len = read_arg(ai);
+            if (len > static_cast<uint64_t>(end - pos)) {
+                throw_error("Unexpected end of input");
+            }
+            auto res = sl::io::make_span(reinterpret_cast<const char*>(pos), static_cast<size_t>(len));
+            pos += len;
+            return res;
+        }
+        chunks.clear();
+        while (!at_break()) {
+            auto head = next_byte();
+            if ((head >> 5) != major || ai_indefinite == (head & 0x1F)) {
+                throw_error("Invalid string chunk");
+            }
+            auto len = read_arg(head & 0x1F);
+            if (len > static_cast<uint64_t>(end - pos)) {
+                throw_error("Unexpected end of input");
+            }
+            chunks.append(reinterpret_cast<const char*>(pos), static_cast<size_t>(len));
+            pos += len;
+        }
+        return sl::io::make_span(chunks.data(), chunks.length());
+    }
+
+    void write_hex(sl::io::span<const char> data) {
+        static const char* hex = "0123456789abcdef";
+        out.push_back('"');
+        for (char ch : data) {
+            auto byte = static_cast<unsigned char>(ch);
+            out.push_back(hex[byte >> 4]);
+            out.push_back(hex[byte & 0xF]);
+        }
+        out.push_back('"');
+    }
+
+    void decode_key(size_t depth) {
+        auto head = next_byte();
+        auto major = static_cast<uint8_t>(head >> 5);
+        auto ai = static_cast<uint8_t>(head & 0x1F);
+        if (major_text == major) {
+            auto str = read_text(ai);
+            write_json_string(out, str.data(), str.size());
+        } else if (major_uint == major || major_negint == major) {
+            // JSON keys are strings
+            out.push_back('"');
+            pos -= 1;
+            decode_item(depth);
+            out.push_back('"');
+        } else {
+            throw_error("Unsupported map key type: [" + sl::support::to_string(static_cast<int>(major)) + "]");
+        }
+    }
+
+    void decode_item(size_t depth) {
+        if (depth > max_depth) {
+            throw_error("Nesting depth exceeded");
+        }
+        auto head = next_byte();
+        auto major = static_cast<uint8_t>(head >> 5);
+        auto ai = static_cast<uint8_t>(head & 0x1F);
+        switch (major) {
+        case major_uint:
+            out.append(sl::support::to_string(read_arg(ai)));
+            break;
+        case major_negint: {
+            auto val = read_arg(ai);
+            out.push_back('-');
+            if (std::numeric_limits<uint64_t>::max() == val) {
+                out.append("18446744073709551616");
+            } else {
+                out.append(sl::support::to_string(val + 1));
+            }
+            break;
+        }
+        case major_bytes:
+            write_hex(read_string_data(major, ai));
+            break;
+        case major_text: {
+            auto str = read_text(ai);
+            write_json_string(out, str.data(), str.size());
+            break;
+        }
+        case major_array: {
+            out.push_back('[');
+            bool indefinite = ai_indefinite == ai;
+            uint64_t count = indefinite ? 0 : read_arg(ai);
+            for (uint64_t i = 0; indefinite ? !at_break() : i < count; i++) {
+                if (i > 0) {
+                    out.push_back(',');
+                }
+                decode_item(depth + 1);
+            }
+            out.push_back(']');
+            break;
+        }
+        case major_map: {
+            out.push_back('{');
+            bool indefinite = ai_indefinite == ai;
+            uint64_t count = indefinite ? 0 : read_arg(ai);
+            for (uint64_t i = 0; indefinite ? !at_break() : i < count; i++) {
+                if (i > 0) {
+                    out.push_back(',');
+                }
+                decode_key(depth + 1);
+                out.push_back(':');
+                decode_item(depth + 1);
+            }
+            out.push_back('}');
+            break;
+        }
+        case major_tag:
+            read_arg(ai);
+            decode_item(depth + 1);
+            break;
+        case major_simple:
+            decode_simple(ai);
+            break;
+        }
+    }
+
+    void decode_simple(uint8_t ai) {
+        switch (ai) {
+        case 20: out.append("false"); break;
+        case 21: out.append("true"); break;
+        case 22: case 23: out.append("null"); break;
+        case 25: write_json_double(out, half_to_double(static_cast<uint16_t>(read_be(2)))); break;
+        case 26: {
+            auto bits = static_cast<uint32_t>(read_be(4));
+            float val = 0;
+            std::memcpy(std::addressof(val), std::addressof(bits), sizeof(val));
+            write_json_double(out, static_cast<double>(val));
+            break;
+        }
+        case 27: {
+            auto bits = read_be(8);
+            double val = 0;
+            std::memcpy(std::addressof(val), std::addressof(bits), sizeof(val));
+            write_json_double(out, val);
+            break;
+        }
+        default:
+            throw_error("Unsupported simple value: [" + sl::support::to_string(static_cast<int>(ai)) + "]");
+        }
+    }
+
+    static double half_to_double(uint16_t half) {
+        int exp = (half >> 10) & 0x1F;
+        int mant = half & 0x3FF;
+        double val = 0;
+        if (0 == exp) {
+            val = std::ldexp(mant, -24);
+        } else if (31 != exp) {
+            val = std::ldexp(mant + 1024, exp - 25);
+        } else {
+            val = 0 == mant ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+        }
+        return 0 != (half & 0x8000) ? -val : val;
+    }
+
+    [[noreturn]] void throw_error(const std::string& msg) {
+        throw support::exception(TRACEMSG("CBOR parse error: " + msg + "," +
+                " position: [" + sl::support::to_string(static_cast<size_t>(pos - begin)) + "]"));
+    }
+};
+
+} // namespace
+
+void json_to_cbor(sl::io::span<const char> json, std::string& out) {
+    support::json_cursor cur{json};
+    auto str = std::string();
+    encode_value(cur, out, str, 0);
+    cur.finish();
+}
+
+void cbor_to_json(sl::io::span<const char> cbor, std::string& out) {
+    cbor_decoder dec{cbor, out};
+    dec.decode();
+}
+
+bool is_known_format(int format) {
+    return WILTONCALL_FORMAT_JSON == format || WILTONCALL_FORMAT_CBOR == format;
+}
+
+sl::io::span<char> transcode_payload(int format_in, sl::io::span<const char> data, int format_out) {
+    if (!is_known_format(format_in)) throw support::exception(TRACEMSG(
+            "Invalid unknown payload format specified: [" + sl::support::to_string(format_in) + "]"));
+    if (!is_known_format(format_out)) throw support::exception(TRACEMSG(
+            "Invalid unknown payload format specified: [" + sl::support::to_string(format_out) + "]"));
+    if (format_in == format_out) {
+        return support::alloc_copy_span(data);
+    }
+    support::detail_buffer::scratch_lease lease;
+    auto local = std::string();
+    auto& out = nullptr != lease.get() ? *lease.get() : local;
+    if (WILTONCALL_FORMAT_CBOR == format_out) {
+        json_to_cbor(data, out);
+    } else {
+        cbor_to_json(data, out);
+    }
+    return support::alloc_copy_span(sl::io::make_span(out.data(), out.length()));
+}
+
+} // namespace
+}
@@ -0,0 +1,37 @@
+/*
+ * File:   cbor_transcoder.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 2:05 PM
+ */
+
+#ifndef WILTON_JSON_CBOR_TRANSCODER_HPP
+#define WILTON_JSON_CBOR_TRANSCODER_HPP
+
+#include <string>
+
+#include "staticlib/io.hpp"
+
+namespace wilton {
+namespace json {
+
+// input is validated as strict JSON with UTF-8 strings,
+// objects and arrays are encoded with indefinite length,
+// reals that fit into single precision are encoded as such
+void json_to_cbor(sl::io::span<const char> json, std::string& out);
+
+// text strings must be valid UTF-8,
+// byte strings are written as hex strings, tags are dropped,
+// 'undefined', NaN and infinities are written as 'null'
+void cbor_to_json(sl::io::span<const char> cbor, std::string& out);
+
+// 'WILTONCALL_FORMAT_*' values
+bool is_known_format(int format);
+
+// returns 'wilton_alloc' allocated buffer
+sl::io::span<char> transcode_payload(int format_in, sl::io::span<const char> data, int format_out);
+
+} // namespace
+}
+
+#endif /* WILTON_JSON_CBOR_TRANSCODER_HPP */
@@ -0,0 +1,304 @@
+/*
+ * File:   structural_index.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 9:25 AM
+ */
+
+#include "json/structural_index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "json/block_classifier.hpp"
+
+namespace wilton {
+namespace json {
+
+namespace { // anonymous
+
+struct scanner {
+    classify_fun_type classify;
+    const char* name;
+};
+
+scanner select_scanner() STATICLIB_NOEXCEPT {
+#ifdef WILTON_JSON_X86_SIMD
+    if (avx2_supported()) {
+        return scanner{classify_avx2, "avx2"};
+    }
+    return scanner{classify_sse2, "sse2"};
+#else // !WILTON_JSON_X86_SIMD
+    return scanner{classify_scalar, "scalar"};
+#endif // WILTON_JSON_X86_SIMD
+}
+
+const scanner& current_scanner() STATICLIB_NOEXCEPT {
+    static const scanner sc = select_scanner();
+    return sc;
+}
+
+size_t trailing_zeros(uint64_t val) STATICLIB_NOEXCEPT {
+#ifdef __GNUC__
+    return static_cast<size_t>(__builtin_ctzll(val));
+#else // !__GNUC__
+    size_t res = 0;
+    while (0 == (val & 1)) {
+        val >>= 1;
+        res += 1;
+    }
+    return res;
+#endif // __GNUC__
+}
+
+// bit i of result is the xor of bits [0, i] of input
+uint64_t prefix_xor(uint64_t val) STATICLIB_NOEXCEPT {
+    val ^= val << 1;
+    val ^= val << 2;
+    val ^= val << 4;
+    val ^= val << 8;
+    val ^= val << 16;
+    val ^= val << 32;
+    return val;
+}
+
+// characters preceded by an odd number of backslashes,
+// carry tells whether the first character of the next block is escaped
+uint64_t find_escaped(uint64_t backslash, uint64_t& carry) STATICLIB_NOEXCEPT {
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    backslash &= ~carry;
+    uint64_t follows_escape = backslash << 1 | carry;
+    uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+    carry = sequences_starting_on_even_bits < odd_sequence_starts ? 1 : 0;
+    uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+[[noreturn]] void throw_invalid(const std::string& msg, size_t offset) {
+    throw support::exception(TRACEMSG("Invalid JSON: " + msg + ", position: [" + sl::support::to_string(offset) + "]"));
+}
+
+bool is_delimiter(char ch) STATICLIB_NOEXCEPT {
+    switch (ch) {
+    case ' ': case '\t': case '\n': case '\r':
+    case '{': case '}': case '[': case ']': case ':': case ',': case '"':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool is_digit(char ch) STATICLIB_NOEXCEPT {
+    return ch >= '0' && ch <= '9';
+}
+
+bool valid_number(const char* begin, const char* end) STATICLIB_NOEXCEPT {
+    auto it = begin;
+    if (it < end && '-' == *it) ++it;
+    if (it == end) return false;
+    if ('0' == *it) {
+        ++it;
+    } else if (is_digit(*it)) {
+        while (it < end && is_digit(*it)) ++it;
+    } else {
+        return false;
+    }
+    if (it < end && '.' == *it) {
+        ++it;
+        if (it == end || !is_digit(*it)) return false;
+        while (it < end && is_digit(*it)) ++it;
+    }
+    if (it < end && ('e' == *it || 'E' == *it)) {
+        ++it;
+        if (it < end && ('+' == *it || '-' == *it)) ++it;
+        if (it == end || !is_digit(*it)) return false;
+        while (it < end && is_digit(*it)) ++it;
+    }
+    return it == end;
+}
+
+void validate_scalar(const char* data, size_t len, size_t offset) {
+    auto begin = data + offset;
+    auto end = begin;
+    auto data_end = data + len;
+    while (end < data_end && !is_delimiter(*end)) ++end;
+    auto tok_len = static_cast<size_t>(end - begin);
+    switch (*begin) {
+    case 't':
+        if (4 == tok_len && 0 == std::memcmp(begin, "true", 4)) return;
+        break;
+    case 'f':
+        if (5 == tok_len && 0 == std::memcmp(begin, "false", 5)) return;
+        break;
+    case 'n':
+        if (4 == tok_len && 0 == std::memcmp(begin, "null", 4)) return;
+        break;
+    default:
+        if (valid_number(begin, end)) return;
+        break;
+    }
+    throw_invalid("Invalid value: [" + std::string(begin, std::min(tok_len, static_cast<size_t>(32))) + "]", offset);
+}
+
+enum class parse_state {
+    value, value_or_close, key_or_close, key, colon, after_value
+};
+
+// stage 1: offsets of structural characters outside strings,
+// of opening quotes and of the first characters of other values
+void find_structurals(const char* data, size_t len, std::vector<int>& offsets) {
+    auto classify = current_scanner().classify;
+    uint64_t escaped_carry = 0;
+    uint64_t in_string_carry = 0;
+    uint64_t scalar_carry = 0;
+    char tail[block_size];
+    for (size_t base = 0; base < len; base += block_size) {
+        const char* block = data + base;
+        if (len - base < block_size) {
+            std::memset(tail, ' ', block_size);
+            std::memcpy(tail, block, len - base);
+            block = tail;
+        }
+        block_masks masks;
+        classify(block, masks);
+        auto escaped = find_escaped(masks.backslash, escaped_carry);
+        auto quote = masks.quote & ~escaped;
+        // opening quotes and string contents, closing quotes are not included
+        auto in_string = prefix_xor(quote) ^ in_string_carry;
+        in_string_carry = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+        auto control_in_string = masks.control & in_string;
+        if (0 != control_in_string) {
+            throw_invalid("Unescaped control character in string", base + trailing_zeros(control_in_string));
+        }
+        auto string_tail = in_string ^ quote;
+        auto nonquote_scalar = ~(masks.op | masks.ws | quote);
+        auto follows_scalar = nonquote_scalar << 1 | scalar_carry;
+        scalar_carry = nonquote_scalar >> 63;
+        auto scalar_start = nonquote_scalar & ~follows_scalar;
+        auto structurals = (masks.op | quote | scalar_start) & ~string_tail;
+        while (0 != structurals) {
+            offsets.push_back(static_cast<int>(base + trailing_zeros(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+    if (0 != in_string_carry) {
+        throw_invalid("Unterminated string", len);
+    }
+}
+
+// stage 2: grammar check and matching of brackets
+void check_grammar(const char* data, size_t len, const std::vector<int>& offsets, std::vector<int>& next) {
+    auto count = offsets.size();
+    if (0 == count) {
+        throw_invalid("Empty input", 0);
+    }
+    next.resize(count);
+    auto open = std::vector<size_t>();
+    auto state = parse_state::value;
+    for (size_t i = 0; i < count; i++) {
+        next[i] = static_cast<int>(i + 1);
+        auto offset = static_cast<size_t>(offsets[i]);
+        auto ch = data[offset];
+        bool closing = false;
+        switch (state) {
+        case parse_state::value_or_close:
+            if (']' == ch) {
+                closing = true;
+                break;
+            }
+            // fall through
+        case parse_state::value:
+            if ('{' == ch) {
+                open.push_back(i);
+                state = parse_state::key_or_close;
+            } else if ('[' == ch) {
+                open.push_back(i);
+                state = parse_state::value_or_close;
+            } else if ('"' == ch) {
+                state = parse_state::after_value;
+            } else if ('}' == ch || ']' == ch || ':' == ch || ',' == ch) {
+                throw_invalid(std::string("Unexpected character: [") + ch + "]", offset);
+            } else {
+                validate_scalar(data, len, offset);
+                state = parse_state::after_value;
+            }
+            break;
+        case parse_state::key_or_close:
+            if ('}' == ch) {
+                closing = true;
+                break;
+            }
+            // fall through
+        case parse_state::key:
+            if ('"' != ch) {
+                throw_invalid("Expected field name", offset);
+            }
+            state = parse_state::colon;
+            break;
+        case parse_state::colon:
+            if (':' != ch) {
+                throw_invalid("Expected: [:]", offset);
+            }
+            state = parse_state::value;
+            break;
+        case parse_state::after_value:
+            if (open.empty()) {
+                throw_invalid("Unexpected trailing data", offset);
+            }
+            if (',' == ch) {
+                state = '{' == data[offsets[open.back()]] ? parse_state::key : parse_state::value;
+            } else if ('}' == ch || ']' == ch) {
+                closing = true;
+            } else {
+                throw_invalid(std::string("Unexpected character: [") + ch + "]", offset);
+            }
+            break;
+        }
+        if (closing) {
+            auto open_ch = data[offsets[open.back()]];
+            if (('{' == open_ch && '}' != ch) || ('[' == open_ch && ']' != ch)) {
+                throw_invalid(std::string("Mismatched bracket: [") + ch + "]", offset);
+            }
+            next[open.back()] = static_cast<int>(i + 1);
+            open.pop_back();
+            state = parse_state::after_value;
+        }
+    }
+    if (parse_state::after_value != state || !open.empty()) {
+        throw_invalid("Unexpected end of input", len);
+    }
+}
+
+} // namespace
+
+void structural_index::build(const char* data, size_t len) {
+    if (len > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw support::exception(TRACEMSG("Invalid JSON: input too large, size: [" + sl::support::to_string(len) + "]"));
+    }
+    offsets.clear();
+    next.clear();
+    try {
+        find_structurals(data, len, offsets);
+        check_grammar(data, len, offsets, next);
+    } catch (...) {
+        // partial index must not be used
+        offsets.clear();
+        next.clear();
+        throw;
+    }
+}
+
+const char* scanner_name() STATICLIB_NOEXCEPT {
+    return current_scanner().name;
+}
+
+} // namespace
+}
@@ -0,0 +1,47 @@
+/*
+ * File:   structural_index.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 9:10 AM
+ */
+
+#ifndef WILTON_JSON_STRUCTURAL_INDEX_HPP
+#define WILTON_JSON_STRUCTURAL_INDEX_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+namespace wilton {
+namespace json {
+
+/**
+ * Offsets of structural characters and of value starts of a validated
+ * JSON document, for every entry 'next' holds the index of the entry
+ * that follows its value (past the matching bracket for containers)
+ */
+class structural_index {
+    std::vector<int> offsets;
+    std::vector<int> next;
+
+public:
+    // throws on invalid JSON, memory is reused between builds
+    void build(const char* data, size_t len);
+
+    const std::vector<int>& get_offsets() const STATICLIB_NOEXCEPT {
+        return offsets;
+    }
+
+    const std::vector<int>& get_next() const STATICLIB_NOEXCEPT {
+        return next;
+    }
+};
+
+// scanner selected for this CPU: "avx2", "sse2" or "scalar"
+const char* scanner_name() STATICLIB_NOEXCEPT;
+
+} // namespace
+}
+
+#endif /* WILTON_JSON_STRUCTURAL_INDEX_HPP */
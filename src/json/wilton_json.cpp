@@ -0,0 +1,71 @@
+/*
+ * File:   wilton_json.cpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 10:15 AM
+ */
+
+#include "wilton/wilton.h"
+
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/alloc_copy.hpp"
+
+#include "json/structural_index.hpp"
+
+struct wilton_JsonIndex {
+private:
+    wilton::json::structural_index idx;
+
+public:
+    wilton::json::structural_index& impl() {
+        return idx;
+    }
+};
+
+char* wilton_json_index_create(wilton_JsonIndex** index_out) /* noexcept */ {
+    if (nullptr == index_out) return wilton::support::alloc_copy(TRACEMSG("Null 'index_out' parameter specified"));
+    try {
+        wilton_JsonIndex* index_ptr = new wilton_JsonIndex();
+        *index_out = index_ptr;
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_json_index_build(wilton_JsonIndex* index, const char* json, int json_len) /* noexcept */ {
+    if (nullptr == index) return wilton::support::alloc_copy(TRACEMSG("Null 'index' parameter specified"));
+    if (nullptr == json) return wilton::support::alloc_copy(TRACEMSG("Null 'json' parameter specified"));
+    if (!sl::support::is_uint32(json_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'json_len' parameter specified: [" + sl::support::to_string(json_len) + "]"));
+    try {
+        index->impl().build(json, static_cast<size_t>(json_len));
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_json_index_get(wilton_JsonIndex* index, const int** offsets_out, const int** next_out,
+        int* count_out) /* noexcept */ {
+    if (nullptr == index) return wilton::support::alloc_copy(TRACEMSG("Null 'index' parameter specified"));
+    if (nullptr == offsets_out) return wilton::support::alloc_copy(TRACEMSG("Null 'offsets_out' parameter specified"));
+    if (nullptr == next_out) return wilton::support::alloc_copy(TRACEMSG("Null 'next_out' parameter specified"));
+    if (nullptr == count_out) return wilton::support::alloc_copy(TRACEMSG("Null 'count_out' parameter specified"));
+    auto& offsets = index->impl().get_offsets();
+    auto& next = index->impl().get_next();
+    *offsets_out = offsets.data();
+    *next_out = next.data();
+    *count_out = static_cast<int>(next.size());
+    return nullptr;
+}
+
+char* wilton_json_index_destroy(wilton_JsonIndex* index) /* noexcept */ {
+    if (nullptr == index) return wilton::support::alloc_copy(TRACEMSG("Null 'index' parameter specified"));
+    delete index;
+    return nullptr;
+}
@@ -7,18 +7,24 @@
 
 #include "wilton/wilton.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
 #include "staticlib/utils.hpp"
 
 #include "wilton/support/alloc_copy.hpp"
+#include "wilton/support/exception.hpp"
 
+#include "alloc/allocator.hpp"
 #include "call/wiltoncall_internal.hpp"
 
 namespace { // anonymous
@@ -33,27 +39,106 @@ std::shared_ptr<std::mutex> shared_mutex() {
     return registry;
 }
 
+// reports are collected under this lock, so unregistered maps can be destroyed
+std::shared_ptr<std::mutex> shared_engine_stats_mutex() {
+    static auto mutex = std::make_shared<std::mutex>();
+    return mutex;
+}
+
+std::shared_ptr<std::vector<std::pair<void*, std::function<sl::json::value()>>>> shared_engine_stats_registry() {
+    static auto registry = std::make_shared<std::vector<std::pair<void*, std::function<sl::json::value()>>>>();
+    return registry;
+}
+
+// returns npos for non-numeric segments
+size_t parse_index(const std::string& segment) {
+    if (segment.empty() || segment.length() > 9) {
+        return std::string::npos;
+    }
+    size_t res = 0;
+    for (char ch : segment) {
+        if (ch < '0' || ch > '9') {
+            return std::string::npos;
+        }
+        res = res * 10 + static_cast<size_t> (ch - '0');
+    }
+    return res;
+}
+
+const sl::json::value& null_json() {
+    static const sl::json::value null_value;
+    return null_value;
+}
+
 } // namespace
 
 char* wilton_alloc(int size_bytes) /* noexcept */ {
     if (!sl::support::is_uint32_positive(size_bytes)) {
         return nullptr;
     }
-    return reinterpret_cast<char*>(std::malloc(static_cast<size_t>(size_bytes)));
+    return wilton::alloc::allocate(static_cast<size_t>(size_bytes));
+}
+
+char* wilton_realloc(char* buffer, int size_bytes) /* noexcept */ {
+    if (!sl::support::is_uint32_positive(size_bytes)) {
+        return nullptr;
+    }
+    return wilton::alloc::reallocate(buffer, static_cast<size_t>(size_bytes));
+}
+
+char* wilton_alloc_detached(int size_bytes) /* noexcept */ {
+    if (!sl::support::is_uint32_positive(size_bytes)) {
+        return nullptr;
+    }
+    return wilton::alloc::allocate_detached(static_cast<size_t>(size_bytes));
 }
 
 void wilton_free(char* buffer) /* noexcept */ {
-    std::free(buffer);
+    wilton::alloc::deallocate(buffer);
 }
 
 char* wilton_config(char** conf_json_out, int* conf_json_len_out) /* noexcept */ {
     if (nullptr == conf_json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'conf_json_out' parameter specified"));
     if (nullptr == conf_json_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'conf_json_len_out' parameter specified"));
     try {
+        auto& bytes = wilton::internal::shared_wiltoncall_config_bytes();
+        auto span = wilton::support::alloc_copy_span(bytes);
+        *conf_json_out = span.data();
+        *conf_json_len_out = static_cast<int>(span.size());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_config_get(const char* path, int path_len,
+        char** value_json_out, int* value_json_len_out) /* noexcept */ {
+    if (nullptr == path) return wilton::support::alloc_copy(TRACEMSG("Null 'path' parameter specified"));
+    if (!sl::support::is_uint16_positive(path_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'path_len' parameter specified: [" + sl::support::to_string(path_len) + "]"));
+    if (nullptr == value_json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'value_json_out' parameter specified"));
+    if (nullptr == value_json_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'value_json_len_out' parameter specified"));
+    try {
+        auto path_str = std::string(path, static_cast<uint16_t> (path_len));
         auto ptr = wilton::internal::shared_wiltoncall_config();
-        auto buf = wilton::support::make_json_buffer(*ptr);
-        *conf_json_out = buf.value().data();
-        *conf_json_len_out = static_cast<int>(buf.value().size());
+        const sl::json::value* val = ptr.get();
+        size_t start = 0;
+        while (start <= path_str.length() && sl::json::type::nullt != val->json_type()) {
+            auto dot = path_str.find('.', start);
+            auto end = std::string::npos != dot ? dot : path_str.length();
+            auto segment = path_str.substr(start, end - start);
+            if (sl::json::type::array == val->json_type()) {
+                auto& arr = val->as_array();
+                auto idx = parse_index(segment);
+                val = idx < arr.size() ? std::addressof(arr[idx]) : std::addressof(null_json());
+            } else {
+                val = std::addressof(val->getattr(segment));
+            }
+            start = end + 1;
+        }
+        auto buf = wilton::support::make_json_buffer(*val);
+        *value_json_out = buf.value().data();
+        *value_json_len_out = static_cast<int>(buf.value().size());
         return nullptr;
     } catch (const std::exception& e) {
         return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
@@ -95,3 +180,64 @@ char* wilton_register_tls_cleaner(void* cleaner_ctx, void (*cleaner_cb)
         return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
     }
 }
+
+char* wilton_register_engine_stats(void* stats_ctx, char* (*stats_cb)
+        (void* stats_ctx, char** stats_json_out, int* stats_json_len_out)) /* noexcept */ {
+    if (nullptr == stats_cb) return wilton::support::alloc_copy(TRACEMSG("Null 'stats_cb' parameter specified"));
+    try {
+        auto fun = [stats_ctx, stats_cb]() -> sl::json::value {
+            char* json = nullptr;
+            int json_len = 0;
+            auto err = stats_cb(stats_ctx, std::addressof(json), std::addressof(json_len));
+            if (nullptr != err) {
+                auto msg = std::string(err);
+                wilton_free(err);
+                throw wilton::support::exception(TRACEMSG(msg));
+            }
+            auto deferred = sl::support::defer([json]() STATICLIB_NOEXCEPT {
+                wilton_free(json);
+            });
+            return sl::json::load({const_cast<const char*>(json), json_len});
+        };
+        auto mx = shared_engine_stats_mutex();
+        std::lock_guard<std::mutex> guard{*mx};
+        auto reg = shared_engine_stats_registry();
+        reg->emplace_back(stats_ctx, std::move(fun));
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_unregister_engine_stats(void* stats_ctx) /* noexcept */ {
+    try {
+        auto mx = shared_engine_stats_mutex();
+        std::lock_guard<std::mutex> guard{*mx};
+        auto reg = shared_engine_stats_registry();
+        reg->erase(std::remove_if(reg->begin(), reg->end(),
+                [stats_ctx](const std::pair<void*, std::function<sl::json::value()>>& pa) {
+                    return stats_ctx == pa.first;
+                }), reg->end());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+namespace wilton {
+namespace internal {
+
+sl::json::value collect_engine_stats() {
+    // maps take their own locks, and never call back here under them
+    auto mx = shared_engine_stats_mutex();
+    std::lock_guard<std::mutex> guard{*mx};
+    auto reg = shared_engine_stats_registry();
+    auto res = std::vector<sl::json::value>();
+    for (auto& pa : *reg) {
+        res.emplace_back(pa.second());
+    }
+    return sl::json::value(std::move(res));
+}
+
+} // namespace
+}
@@ -16,7 +16,7 @@ namespace wilton {
 namespace misc {
 
 support::buffer get_wiltoncall_config(sl::io::span<const char>) {
-    return support::make_json_buffer(*internal::shared_wiltoncall_config());
+    return support::make_string_buffer(internal::shared_wiltoncall_config_bytes());
 }
 
 support::buffer stdin_readline(sl::io::span<const char>) {
@@ -25,5 +25,10 @@ support::buffer stdin_readline(sl::io::span<const char>) {
     return support::make_string_buffer(res);
 }
 
+support::buffer get_engine_stats(sl::io::span<const char>) {
+    auto stats = internal::collect_engine_stats();
+    return support::make_json_buffer(stats);
+}
+
 } // namespace
 }
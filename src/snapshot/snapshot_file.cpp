@@ -0,0 +1,213 @@
+/*
+ * File:   snapshot_file.cpp
+ * Author: alex
+ *
+ * Created on October 19, 2026, 2:45 PM
+ */
+
+#include "snapshot/snapshot_file.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include "staticlib/support.hpp"
+
+#ifndef STATICLIB_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // !STATICLIB_WINDOWS
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace snapshot {
+
+namespace { // anonymous
+
+const char magic[8] = {'W', 'L', 'T', 'N', 'S', 'N', 'A', 'P'};
+const uint32_t format_version = 1;
+// magic, format version, version length, data length, checksum
+const size_t header_len = 32;
+// snapshot data may be read as bytecode that expects aligned input
+const size_t data_alignment = 16;
+
+size_t data_offset_for(size_t version_len) {
+    auto len = header_len + version_len;
+    return (len + data_alignment - 1) & ~(data_alignment - 1);
+}
+
+template<typename T>
+T read_field(const char* src) {
+    T res;
+    std::memcpy(std::addressof(res), src, sizeof(T));
+    return res;
+}
+
+template<typename T>
+void write_field(char* dest, T val) {
+    std::memcpy(dest, std::addressof(val), sizeof(T));
+}
+
+// checks the header and the checksum, returns data offset or 0 if the file is not usable
+size_t validate(const char* file, size_t file_len, const std::string& version, size_t& data_len) {
+    if (file_len < header_len || 0 != std::memcmp(file, magic, sizeof(magic)) ||
+            format_version != read_field<uint32_t>(file + 8)) {
+        return 0;
+    }
+    auto version_len = static_cast<size_t>(read_field<uint32_t>(file + 12));
+    auto len = read_field<uint64_t>(file + 16);
+    auto checksum = read_field<uint64_t>(file + 24);
+    if (version_len != version.length() || header_len + version_len > file_len ||
+            0 != std::memcmp(file + header_len, version.data(), version_len)) {
+        return 0;
+    }
+    auto offset = data_offset_for(version_len);
+    if (offset > file_len || len != file_len - offset ||
+            checksum != snapshot_checksum(file + offset, static_cast<size_t>(len))) {
+        return 0;
+    }
+    data_len = static_cast<size_t>(len);
+    return offset;
+}
+
+std::string temp_path(const std::string& path) {
+    auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+    return path + "." + sl::support::to_string_any(std::this_thread::get_id()) +
+            "_" + sl::support::to_string(ticks) + ".tmp";
+}
+
+} // namespace
+
+snapshot_file::~snapshot_file() STATICLIB_NOEXCEPT {
+#ifndef STATICLIB_WINDOWS
+    if (nullptr != mapped) {
+        ::munmap(const_cast<char*>(mapped), mapped_len);
+    }
+#endif // !STATICLIB_WINDOWS
+}
+
+std::unique_ptr<snapshot_file> snapshot_file::open(const std::string& path, const std::string& version) {
+    auto res = std::unique_ptr<snapshot_file>(new snapshot_file());
+    const char* file = nullptr;
+    size_t file_len = 0;
+#ifdef STATICLIB_WINDOWS
+    // no mapping, file is read into memory
+    std::ifstream stream{path, std::ios::in | std::ios::binary};
+    if (!stream.is_open()) {
+        return nullptr;
+    }
+    res->contents.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    if (stream.bad()) {
+        throw support::exception(TRACEMSG("Error reading snapshot file, path: [" + path + "]"));
+    }
+    file = res->contents.data();
+    file_len = res->contents.length();
+#else // !STATICLIB_WINDOWS
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (-1 == fd) {
+        if (ENOENT == errno) {
+            return nullptr;
+        }
+        throw support::exception(TRACEMSG("Error opening snapshot file, path: [" + path + "]," +
+                " error: [" + ::strerror(errno) + "]"));
+    }
+    auto deferred = sl::support::defer([fd]() STATICLIB_NOEXCEPT {
+        ::close(fd);
+    });
+    struct stat st;
+    if (-1 == ::fstat(fd, std::addressof(st))) {
+        throw support::exception(TRACEMSG("Error reading snapshot file, path: [" + path + "]," +
+                " error: [" + ::strerror(errno) + "]"));
+    }
+    if (static_cast<size_t>(st.st_size) < header_len) {
+        return nullptr;
+    }
+    auto addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == addr) {
+        throw support::exception(TRACEMSG("Error mapping snapshot file, path: [" + path + "]," +
+                " error: [" + ::strerror(errno) + "]"));
+    }
+    res->mapped = static_cast<const char*>(addr);
+    res->mapped_len = static_cast<size_t>(st.st_size);
+    file = res->mapped;
+    file_len = res->mapped_len;
+#endif // STATICLIB_WINDOWS
+    res->data_offset = validate(file, file_len, version, res->data_len);
+    if (0 == res->data_offset) {
+        return nullptr;
+    }
+    return res;
+}
+
+sl::io::span<const char> snapshot_file::data() const STATICLIB_NOEXCEPT {
+    auto file = nullptr != mapped ? mapped : contents.data();
+    return sl::io::make_span(file + data_offset, data_len);
+}
+
+void write_snapshot_file(const std::string& path, const std::string& version,
+        sl::io::span<const char> data) {
+    auto offset = data_offset_for(version.length());
+    auto header = std::string(offset, '\0');
+    std::memcpy(std::addressof(header.front()), magic, sizeof(magic));
+    write_field<uint32_t>(std::addressof(header[8]), format_version);
+    write_field<uint32_t>(std::addressof(header[12]), static_cast<uint32_t>(version.length()));
+    write_field<uint64_t>(std::addressof(header[16]), static_cast<uint64_t>(data.size()));
+    write_field<uint64_t>(std::addressof(header[24]), snapshot_checksum(data.data(), data.size()));
+    std::memcpy(std::addressof(header[header_len]), version.data(), version.length());
+
+    auto tmp = temp_path(path);
+    {
+        std::ofstream stream{tmp, std::ios::out | std::ios::binary | std::ios::trunc};
+        stream.write(header.data(), static_cast<std::streamsize>(header.length()));
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        stream.close();
+        if (stream.fail()) {
+            std::remove(tmp.c_str());
+            throw support::exception(TRACEMSG("Error writing snapshot file, path: [" + tmp + "]"));
+        }
+    }
+#ifdef STATICLIB_WINDOWS
+    // rename does not replace existing files
+    std::remove(path.c_str());
+#endif // STATICLIB_WINDOWS
+    if (0 != std::rename(tmp.c_str(), path.c_str())) {
+        std::remove(tmp.c_str());
+        throw support::exception(TRACEMSG("Error renaming snapshot file, path: [" + tmp + "]," +
+                " target: [" + path + "]"));
+    }
+}
+
+void remove_snapshot_file(const std::string& path) {
+    errno = 0;
+    if (0 != std::remove(path.c_str()) && ENOENT != errno) {
+        throw support::exception(TRACEMSG("Error removing snapshot file, path: [" + path + "]," +
+                " error: [" + ::strerror(errno) + "]"));
+    }
+}
+
+// FNV-1a over 8-byte words with high bits folded back,
+// detects corruption, not tampering
+uint64_t snapshot_checksum(const char* data, size_t len) STATICLIB_NOEXCEPT {
+    uint64_t res = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        res ^= read_field<uint64_t>(data + i);
+        res *= 1099511628211ull;
+        res ^= res >> 32;
+    }
+    for (; i < len; i++) {
+        res ^= static_cast<uint8_t>(data[i]);
+        res *= 1099511628211ull;
+    }
+    return res;
+}
+
+} // namespace
+}
@@ -0,0 +1,64 @@
+/*
+ * File:   snapshot_file.hpp
+ * Author: alex
+ *
+ * Created on October 19, 2026, 2:30 PM
+ */
+
+#ifndef WILTON_SNAPSHOT_SNAPSHOT_FILE_HPP
+#define WILTON_SNAPSHOT_SNAPSHOT_FILE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/io.hpp"
+
+namespace wilton {
+namespace snapshot {
+
+/**
+ * Cache file with engine snapshot data, file starts with a header that holds
+ * format version, snapshot version string, data length and data checksum;
+ * data is memory-mapped where the platform allows it and is read into memory otherwise
+ */
+class snapshot_file {
+    const char* mapped = nullptr;
+    size_t mapped_len = 0;
+    std::string contents;
+    size_t data_offset = 0;
+    size_t data_len = 0;
+
+public:
+    snapshot_file() { }
+
+    snapshot_file(const snapshot_file&) = delete;
+
+    snapshot_file& operator=(const snapshot_file&) = delete;
+
+    ~snapshot_file() STATICLIB_NOEXCEPT;
+
+    // empty pointer if the file is missing, was written for another
+    // version or is corrupted, throws on IO errors
+    static std::unique_ptr<snapshot_file> open(const std::string& path, const std::string& version);
+
+    // stays valid while the object is alive
+    sl::io::span<const char> data() const STATICLIB_NOEXCEPT;
+};
+
+// writes a temporary file and renames it over the previous one,
+// snapshots mapped from the previous file stay valid
+void write_snapshot_file(const std::string& path, const std::string& version,
+        sl::io::span<const char> data);
+
+// does nothing if the file is missing, snapshots mapped
+// from the removed file stay valid
+void remove_snapshot_file(const std::string& path);
+
+uint64_t snapshot_checksum(const char* data, size_t len) STATICLIB_NOEXCEPT;
+
+} // namespace
+}
+
+#endif /* WILTON_SNAPSHOT_SNAPSHOT_FILE_HPP */
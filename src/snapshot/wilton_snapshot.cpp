@@ -0,0 +1,186 @@
+/*
+ * File:   wilton_snapshot.cpp
+ * Author: alex
+ *
+ * Created on October 19, 2026, 3:20 PM
+ */
+
+#include "wilton/wilton.h"
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/alloc_copy.hpp"
+#include "wilton/support/exception.hpp"
+
+#include "call/wiltoncall_internal.hpp"
+#include "snapshot/snapshot_file.hpp"
+
+namespace { // anonymous
+
+std::shared_ptr<std::mutex> shared_mutex() {
+    static auto mutex = std::make_shared<std::mutex>();
+    return mutex;
+}
+
+// loaded files are kept until exit, engines may reference snapshot data for their lifetime
+std::shared_ptr<std::map<std::string, std::unique_ptr<wilton::snapshot::snapshot_file>>> shared_registry() {
+    static auto map = std::make_shared<std::map<std::string, std::unique_ptr<wilton::snapshot::snapshot_file>>>();
+    return map;
+}
+
+// removed entries, their data may still be referenced by engines
+std::shared_ptr<std::vector<std::unique_ptr<wilton::snapshot::snapshot_file>>> shared_retired() {
+    static auto vec = std::make_shared<std::vector<std::unique_ptr<wilton::snapshot::snapshot_file>>>();
+    return vec;
+}
+
+// empty if the cache is disabled
+const std::string& cache_directory() {
+    static const std::string dir = []() -> std::string {
+        auto conf = wilton::internal::shared_wiltoncall_config();
+        auto& dir_json = conf->getattr("snapshotCache").getattr("directory");
+        if (sl::json::type::nullt == dir_json.json_type()) {
+            return std::string();
+        }
+        return dir_json.as_string_nonempty_or_throw("snapshotCache.directory");
+    }();
+    return dir;
+}
+
+// names become file names
+void check_name(const std::string& name) {
+    for (char ch : name) {
+        if (!((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') ||
+                '_' == ch || '-' == ch || '.' == ch)) {
+            throw wilton::support::exception(TRACEMSG("Invalid snapshot name: [" + name + "]"));
+        }
+    }
+    if ('.' == name.front()) {
+        throw wilton::support::exception(TRACEMSG("Invalid snapshot name: [" + name + "]"));
+    }
+}
+
+std::string snapshot_path(const std::string& name) {
+    return cache_directory() + "/" + name + ".snapshot";
+}
+
+} // namespace
+
+char* wilton_snapshot_load(const char* name, int name_len, const char* version, int version_len,
+        const char** data_out, int* data_len_out) /* noexcept */ {
+    if (nullptr == name) return wilton::support::alloc_copy(TRACEMSG("Null 'name' parameter specified"));
+    if (!sl::support::is_uint16_positive(name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'name_len' parameter specified: [" + sl::support::to_string(name_len) + "]"));
+    if (nullptr == version) return wilton::support::alloc_copy(TRACEMSG("Null 'version' parameter specified"));
+    if (!sl::support::is_uint16_positive(version_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'version_len' parameter specified: [" + sl::support::to_string(version_len) + "]"));
+    if (nullptr == data_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out' parameter specified"));
+    if (nullptr == data_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_len_out' parameter specified"));
+    try {
+        auto name_str = std::string(name, static_cast<uint16_t> (name_len));
+        auto version_str = std::string(version, static_cast<uint16_t> (version_len));
+        check_name(name_str);
+        *data_out = nullptr;
+        *data_len_out = 0;
+        if (cache_directory().empty()) {
+            return nullptr;
+        }
+        auto mx = shared_mutex();
+        std::lock_guard<std::mutex> guard{*mx};
+        auto reg = shared_registry();
+        auto key = name_str + "\n" + version_str;
+        auto it = reg->find(key);
+        if (reg->end() == it) {
+            auto file = wilton::snapshot::snapshot_file::open(snapshot_path(name_str), version_str);
+            if (nullptr == file.get()) {
+                return nullptr;
+            }
+            it = reg->insert(std::make_pair(key, std::move(file))).first;
+        }
+        auto data = it->second->data();
+        if (data.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            throw wilton::support::exception(TRACEMSG(
+                    "Invalid snapshot size: [" + sl::support::to_string(data.size()) + "]"));
+        }
+        *data_out = data.data();
+        *data_len_out = static_cast<int>(data.size());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_snapshot_store(const char* name, int name_len, const char* version, int version_len,
+        const char* data, int data_len) /* noexcept */ {
+    if (nullptr == name) return wilton::support::alloc_copy(TRACEMSG("Null 'name' parameter specified"));
+    if (!sl::support::is_uint16_positive(name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'name_len' parameter specified: [" + sl::support::to_string(name_len) + "]"));
+    if (nullptr == version) return wilton::support::alloc_copy(TRACEMSG("Null 'version' parameter specified"));
+    if (!sl::support::is_uint16_positive(version_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'version_len' parameter specified: [" + sl::support::to_string(version_len) + "]"));
+    if (nullptr == data) return wilton::support::alloc_copy(TRACEMSG("Null 'data' parameter specified"));
+    if (!sl::support::is_uint32(data_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'data_len' parameter specified: [" + sl::support::to_string(data_len) + "]"));
+    try {
+        auto name_str = std::string(name, static_cast<uint16_t> (name_len));
+        auto version_str = std::string(version, static_cast<uint16_t> (version_len));
+        check_name(name_str);
+        if (cache_directory().empty()) {
+            return nullptr;
+        }
+        wilton::snapshot::write_snapshot_file(snapshot_path(name_str), version_str,
+                sl::io::make_span(data, static_cast<size_t>(data_len)));
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_snapshot_remove(const char* name, int name_len) /* noexcept */ {
+    if (nullptr == name) return wilton::support::alloc_copy(TRACEMSG("Null 'name' parameter specified"));
+    if (!sl::support::is_uint16_positive(name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'name_len' parameter specified: [" + sl::support::to_string(name_len) + "]"));
+    try {
+        auto name_str = std::string(name, static_cast<uint16_t> (name_len));
+        check_name(name_str);
+        if (cache_directory().empty()) {
+            return nullptr;
+        }
+        auto mx = shared_mutex();
+        std::lock_guard<std::mutex> guard{*mx};
+        auto reg = shared_registry();
+        auto retired = shared_retired();
+        auto prefix = name_str + "\n";
+        for (auto it = reg->begin(); it != reg->end();) {
+            if (0 == it->first.compare(0, prefix.length(), prefix)) {
+                retired->emplace_back(std::move(it->second));
+                it = reg->erase(it);
+            } else {
+                ++it;
+            }
+        }
+        wilton::snapshot::remove_snapshot_file(snapshot_path(name_str));
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_snapshot_enabled(int* enabled_out) /* noexcept */ {
+    if (nullptr == enabled_out) return wilton::support::alloc_copy(TRACEMSG("Null 'enabled_out' parameter specified"));
+    try {
+        *enabled_out = cache_directory().empty() ? 0 : 1;
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
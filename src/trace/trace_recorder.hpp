@@ -0,0 +1,73 @@
+/*
+ * File:   trace_recorder.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:40 PM
+ */
+
+#ifndef WILTON_TRACE_TRACE_RECORDER_HPP
+#define WILTON_TRACE_TRACE_RECORDER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace trace {
+
+extern std::atomic<bool> enabled_flag;
+
+// the only check done on traced paths when tracing is disabled
+inline bool enabled() STATICLIB_NOEXCEPT {
+    return enabled_flag.load(std::memory_order_relaxed);
+}
+
+void set_enabled(bool enabled) STATICLIB_NOEXCEPT;
+
+// records event into the ring buffer of the current thread,
+// category and name are truncated to fit into the event
+void record(char phase, const char* category, size_t category_len,
+        const char* name, size_t name_len) STATICLIB_NOEXCEPT;
+
+// events of all threads in Chrome trace-event format
+sl::json::value dump(bool clear);
+
+/**
+ * Records begin and end events of a scope, when tracing
+ * was enabled at the beginning of the scope
+ */
+class scope {
+    const char* category;
+    const char* name;
+    size_t name_len;
+    bool active;
+
+public:
+    scope(const char* category, const std::string& name) STATICLIB_NOEXCEPT :
+    category(category),
+    name(name.data()),
+    name_len(name.length()),
+    active(enabled()) {
+        if (active) {
+            record('B', category, std::char_traits<char>::length(category), this->name, name_len);
+        }
+    }
+
+    scope(const scope&) = delete;
+
+    scope& operator=(const scope&) = delete;
+
+    ~scope() STATICLIB_NOEXCEPT {
+        if (active) {
+            record('E', category, std::char_traits<char>::length(category), name, name_len);
+        }
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_TRACE_TRACE_RECORDER_HPP */
@@ -0,0 +1,234 @@
+/*
+ * File:   wilton_trace.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:55 PM
+ */
+
+#include "wilton/wilton.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/alloc_copy.hpp"
+
+#include "trace/trace_recorder.hpp"
+
+namespace wilton {
+namespace trace {
+
+std::atomic<bool> enabled_flag{false};
+
+namespace { // anonymous
+
+const size_t ring_capacity = 1 << 12;
+const size_t max_exited_buffers = 64;
+
+// written only by the owner thread, slot sequence
+// is used to detect slots overwritten during the dump
+struct event {
+    std::atomic<uint64_t> seq;
+    uint64_t ts_nanos;
+    char phase;
+    char category[16];
+    char name[48];
+
+    event() :
+    seq(0) { }
+};
+
+class thread_buffer {
+public:
+    const uint64_t tid;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> cleared;
+    std::atomic<bool> exited;
+    std::array<event, ring_capacity> events;
+
+    thread_buffer(uint64_t tid) :
+    tid(tid),
+    head(0),
+    cleared(0),
+    exited(false) { }
+
+    thread_buffer(const thread_buffer&) = delete;
+
+    thread_buffer& operator=(const thread_buffer&) = delete;
+};
+
+class buffers_registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+    uint64_t next_tid = 1;
+
+public:
+    std::shared_ptr<thread_buffer> create() {
+        std::lock_guard<std::mutex> guard{mutex};
+        // buffers of exited threads are kept for dumps, only the latest ones
+        auto exited_count = std::count_if(buffers.begin(), buffers.end(),
+                [](const std::shared_ptr<thread_buffer>& bu) {
+                    return bu->exited.load();
+                });
+        for (auto it = buffers.begin(); exited_count > static_cast<std::ptrdiff_t>(max_exited_buffers) &&
+                it != buffers.end();) {
+            if ((*it)->exited.load()) {
+                it = buffers.erase(it);
+                exited_count -= 1;
+            } else {
+                ++it;
+            }
+        }
+        auto res = std::make_shared<thread_buffer>(next_tid++);
+        buffers.push_back(res);
+        return res;
+    }
+
+    std::vector<std::shared_ptr<thread_buffer>> list() {
+        std::lock_guard<std::mutex> guard{mutex};
+        return buffers;
+    }
+};
+
+std::shared_ptr<buffers_registry> shared_registry() {
+    static auto reg = std::make_shared<buffers_registry>();
+    return reg;
+}
+
+class buffer_holder {
+public:
+    std::shared_ptr<thread_buffer> buffer;
+
+    ~buffer_holder() STATICLIB_NOEXCEPT {
+        if (nullptr != buffer.get()) {
+            buffer->exited.store(true);
+        }
+    }
+};
+
+thread_buffer* current_buffer() {
+    thread_local buffer_holder holder;
+    if (nullptr == holder.buffer.get()) {
+        auto reg = shared_registry();
+        holder.buffer = reg->create();
+    }
+    return holder.buffer.get();
+}
+
+uint64_t now_nanos() STATICLIB_NOEXCEPT {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+template<size_t N>
+void copy_truncated(char (&dest)[N], const char* src, size_t src_len) STATICLIB_NOEXCEPT {
+    auto len = std::min(src_len, N - 1);
+    std::memcpy(dest, src, len);
+    dest[len] = '\0';
+}
+
+} // namespace
+
+void set_enabled(bool enabled) STATICLIB_NOEXCEPT {
+    enabled_flag.store(enabled, std::memory_order_relaxed);
+}
+
+void record(char phase, const char* category, size_t category_len,
+        const char* name, size_t name_len) STATICLIB_NOEXCEPT {
+    try {
+        auto buf = current_buffer();
+        auto idx = buf->head.load(std::memory_order_relaxed);
+        auto& ev = buf->events[idx % ring_capacity];
+        ev.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        ev.ts_nanos = now_nanos();
+        ev.phase = phase;
+        copy_truncated(ev.category, category, category_len);
+        copy_truncated(ev.name, name, name_len);
+        ev.seq.store(idx + 1, std::memory_order_release);
+        buf->head.store(idx + 1, std::memory_order_release);
+    } catch (...) {
+        // event is lost
+    }
+}
+
+sl::json::value dump(bool clear) {
+    auto reg = shared_registry();
+    auto events = std::vector<sl::json::value>();
+    for (auto& buf : reg->list()) {
+        auto head = buf->head.load(std::memory_order_acquire);
+        auto start = head > ring_capacity ? head - ring_capacity : 0;
+        start = std::max(start, buf->cleared.load());
+        for (auto idx = start; idx < head; idx++) {
+            auto& ev = buf->events[idx % ring_capacity];
+            if (idx + 1 != ev.seq.load(std::memory_order_acquire)) continue;
+            auto ts_nanos = ev.ts_nanos;
+            auto phase = ev.phase;
+            char category[sizeof(ev.category)];
+            std::memcpy(category, ev.category, sizeof(category));
+            char name[sizeof(ev.name)];
+            std::memcpy(name, ev.name, sizeof(name));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (idx + 1 != ev.seq.load(std::memory_order_relaxed)) continue;
+            category[sizeof(category) - 1] = '\0';
+            name[sizeof(name) - 1] = '\0';
+            events.emplace_back(sl::json::value({
+                { "name", std::string(name) },
+                { "cat", std::string(category) },
+                { "ph", std::string(1, phase) },
+                { "ts", static_cast<double>(ts_nanos) / 1000 },
+                { "pid", 1 },
+                { "tid", static_cast<int64_t>(buf->tid) }
+            }));
+        }
+        if (clear) {
+            buf->cleared.store(head);
+        }
+    }
+    return {
+        { "traceEvents", std::move(events) },
+        { "displayTimeUnit", "ns" }
+    };
+}
+
+} // namespace
+}
+
+char* wilton_trace_begin(const char* category, int category_len,
+        const char* name, int name_len) /* noexcept */ {
+    if (!wilton::trace::enabled()) return nullptr;
+    if (nullptr == category) return wilton::support::alloc_copy(TRACEMSG("Null 'category' parameter specified"));
+    if (!sl::support::is_uint16_positive(category_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'category_len' parameter specified: [" + sl::support::to_string(category_len) + "]"));
+    if (nullptr == name) return wilton::support::alloc_copy(TRACEMSG("Null 'name' parameter specified"));
+    if (!sl::support::is_uint16_positive(name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'name_len' parameter specified: [" + sl::support::to_string(name_len) + "]"));
+    wilton::trace::record('B', category, static_cast<uint16_t> (category_len),
+            name, static_cast<uint16_t> (name_len));
+    return nullptr;
+}
+
+char* wilton_trace_end(const char* category, int category_len,
+        const char* name, int name_len) /* noexcept */ {
+    if (!wilton::trace::enabled()) return nullptr;
+    if (nullptr == category) return wilton::support::alloc_copy(TRACEMSG("Null 'category' parameter specified"));
+    if (!sl::support::is_uint16_positive(category_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'category_len' parameter specified: [" + sl::support::to_string(category_len) + "]"));
+    if (nullptr == name) return wilton::support::alloc_copy(TRACEMSG("Null 'name' parameter specified"));
+    if (!sl::support::is_uint16_positive(name_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'name_len' parameter specified: [" + sl::support::to_string(name_len) + "]"));
+    wilton::trace::record('E', category, static_cast<uint16_t> (category_len),
+            name, static_cast<uint16_t> (name_len));
+    return nullptr;
+}
@@ -0,0 +1,51 @@
+/*
+ * File:   wiltoncall_trace.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 4:20 PM
+ */
+
+#include "call/wiltoncall_internal.hpp"
+
+#include "trace/trace_recorder.hpp"
+
+namespace wilton {
+namespace trace {
+
+support::buffer trace_set_enabled(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int enabled = -1;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("enabled" == name) {
+            enabled = fi.as_bool_or_throw(name) ? 1 : 0;
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == enabled) throw support::exception(TRACEMSG(
+            "Required parameter 'enabled' not specified"));
+    // call
+    set_enabled(1 == enabled);
+    return support::make_empty_buffer();
+}
+
+support::buffer trace_dump(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    bool clear = false;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("clear" == name) {
+            clear = fi.as_bool_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    // call
+    return support::make_json_result(dump(clear));
+}
+
+} // namespace
+}
@@ -0,0 +1,369 @@
+/*
+ * File:   wilton_bench.cpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 11:40 PM
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+
+#include "wilton/wilton.h"
+#include "wilton/wiltoncall.h"
+
+#include "wilton/support/buffer.hpp"
+#include "wilton/support/engine_pool.hpp"
+#include "wilton/support/json_cursor.hpp"
+#include "wilton/support/json_schema.hpp"
+#include "wilton/support/json_view.hpp"
+#include "wilton/support/misc.hpp"
+#ifdef WILTON_BENCH_ENGINE_MAP
+#include "wilton/support/script_engine_map.hpp"
+#endif // WILTON_BENCH_ENGINE_MAP
+
+namespace { // anonymous
+
+uint64_t now_micros() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+// median of the runs, iterations are reduced for large payloads
+uint64_t measure(size_t payload_size, const std::function<void()>& fun) {
+    auto iterations = std::max(static_cast<size_t>(3), std::min(static_cast<size_t>(1000), (64u << 20) / payload_size));
+    auto times = std::vector<uint64_t>();
+    for (size_t i = 0; i < iterations; i++) {
+        auto start = now_micros();
+        fun();
+        times.push_back(now_micros() - start);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// two small fields after a large subtree, as in handlers that
+// receive bulk data along with a couple of parameters
+std::string make_payload(size_t size) {
+    auto res = std::string("{\"data\": [");
+    size_t idx = 0;
+    while (res.length() < size) {
+        if (idx > 0) {
+            res.append(",");
+        }
+        res.append("{\"id\": " + std::to_string(idx) + ", \"label\": \"item \\\"" + std::to_string(idx) +
+                "\\\"\", \"tags\": [\"a\", \"b\"], \"weight\": 0.5}");
+        idx += 1;
+    }
+    res.append("], \"name\": \"foo\", \"directory\": \"/tmp\"}");
+    return res;
+}
+
+void check_err(char* err) {
+    if (nullptr != err) {
+        std::puts(err);
+        wilton_free(err);
+        std::exit(1);
+    }
+}
+
+void bench_cursor(const std::vector<size_t>& sizes) {
+    wilton_JsonIndex* index = nullptr;
+    check_err(wilton_json_index_create(std::addressof(index)));
+    std::printf("%-24s %12s %12s %12s %12s\n", "json input", "bytes", "dom, us", "cursor, us", "index, us");
+    for (auto size : sizes) {
+        auto payload = make_payload(size);
+        auto span = sl::io::make_span(payload.data(), payload.length());
+        std::string name;
+        std::string directory;
+        auto dom = measure(payload.length(), [&] {
+            auto json = sl::json::load(span);
+            name = json["name"].as_string_nonempty_or_throw("name");
+            directory = json["directory"].as_string_nonempty_or_throw("directory");
+        });
+        auto cursor = measure(payload.length(), [&] {
+            wilton::support::json_cursor cur{span};
+            cur.enter_object();
+            while (cur.next_field()) {
+                if ("name" == cur.key()) {
+                    name = cur.read_string();
+                } else if ("directory" == cur.key()) {
+                    directory = cur.read_string();
+                } else {
+                    cur.skip();
+                }
+            }
+            cur.finish();
+        });
+        // validates the whole input, unlike the cursor that skips subtrees
+        auto indexed = measure(payload.length(), [&] {
+            check_err(wilton_json_index_build(index, payload.data(), static_cast<int>(payload.length())));
+            const int* offsets = nullptr;
+            const int* next = nullptr;
+            int count = 0;
+            check_err(wilton_json_index_get(index, std::addressof(offsets), std::addressof(next),
+                    std::addressof(count)));
+            wilton::support::json_view view{span, offsets, next, count};
+            auto root = view.root();
+            name = root["name"].as_string_nonempty_or_throw("name");
+            directory = root["directory"].as_string_nonempty_or_throw("directory");
+        });
+        std::printf("%-24s %12zu %12llu %12llu %12llu\n", "two fields", payload.length(),
+                static_cast<unsigned long long>(dom), static_cast<unsigned long long>(cursor),
+                static_cast<unsigned long long>(indexed));
+    }
+    check_err(wilton_json_index_destroy(index));
+}
+
+// numeric arrays, as in handlers that exchange measurements
+std::string make_numeric_payload(size_t size) {
+    auto res = std::string("{\"values\": [");
+    size_t idx = 0;
+    while (res.length() < size) {
+        if (idx > 0) {
+            res.append(",");
+        }
+        res.append("[" + std::to_string(idx) + ", " + std::to_string(static_cast<double>(idx) / 7) + "]");
+        idx += 1;
+    }
+    res.append("]}");
+    return res;
+}
+
+void bench_transcode(const std::vector<size_t>& sizes) {
+    std::printf("\n%-24s %12s %12s %12s %12s\n", "json input", "bytes", "cbor bytes", "to cbor, us", "to json, us");
+    for (auto size : sizes) {
+        auto payload = make_numeric_payload(size);
+        char* cbor = nullptr;
+        int cbor_len = 0;
+        check_err(wiltoncall_transcode(WILTONCALL_FORMAT_JSON, payload.data(), static_cast<int>(payload.length()),
+                WILTONCALL_FORMAT_CBOR, std::addressof(cbor), std::addressof(cbor_len)));
+        auto to_cbor = measure(payload.length(), [&] {
+            char* out = nullptr;
+            int out_len = 0;
+            check_err(wiltoncall_transcode(WILTONCALL_FORMAT_JSON, payload.data(), static_cast<int>(payload.length()),
+                    WILTONCALL_FORMAT_CBOR, std::addressof(out), std::addressof(out_len)));
+            wilton_free(out);
+        });
+        auto to_json = measure(payload.length(), [&] {
+            char* out = nullptr;
+            int out_len = 0;
+            check_err(wiltoncall_transcode(WILTONCALL_FORMAT_CBOR, cbor, cbor_len,
+                    WILTONCALL_FORMAT_JSON, std::addressof(out), std::addressof(out_len)));
+            wilton_free(out);
+        });
+        wilton_free(cbor);
+        std::printf("%-24s %12zu %12d %12llu %12llu\n", "numeric pairs", payload.length(), cbor_len,
+                static_cast<unsigned long long>(to_cbor), static_cast<unsigned long long>(to_json));
+    }
+}
+
+// field checks as they were written before the schemas
+void check_callback_script_chain(const sl::json::value& obj) {
+    bool module = false;
+    for (const sl::json::field& fi : obj.as_object()) {
+        auto& name = fi.name();
+        if ("module" == name) {
+            if (sl::json::type::string != fi.json_type()) throw std::runtime_error(name);
+            module = true;
+        } else if ("func" == name) {
+            if (sl::json::type::string != fi.json_type()) throw std::runtime_error(name);
+        } else if ("args" == name) {
+            if (sl::json::type::array != fi.json_type()) throw std::runtime_error(name);
+        } else if ("engine" == name) {
+            if (sl::json::type::string != fi.json_type()) throw std::runtime_error(name);
+        } else {
+            throw std::runtime_error(name);
+        }
+    }
+    if (!module) throw std::runtime_error("module");
+}
+
+void bench_schema() {
+    const size_t iterations = 100000;
+    // median of three runs
+    const size_t runs_hint = 64u << 20;
+    auto script = std::string("{\"module\": \"app/handlers/orders\", \"func\": \"list\",") +
+            " \"args\": [], \"engine\": \"duktape\"}";
+    auto script_json = sl::json::loads(script);
+    auto script_field = sl::json::field("callbackScript", script_json.clone());
+    auto dyload = std::string("{\"name\": \"wilton_db\", \"directory\": \"/opt/wilton/bin\"}");
+    auto dyload_span = sl::io::make_span(dyload.data(), dyload.length());
+    static const auto dyload_schema = wilton::support::make_json_schema(
+            wilton::support::required_field("name", wilton::support::field_kind::string_nonempty),
+            wilton::support::optional_field("directory", wilton::support::field_kind::string_nonempty));
+    std::string name;
+    std::string directory;
+
+    auto script_chain = measure(runs_hint, [&] {
+        for (size_t i = 0; i < iterations; i++) {
+            check_callback_script_chain(script_json);
+        }
+    });
+    auto script_schema = measure(runs_hint, [&] {
+        for (size_t i = 0; i < iterations; i++) {
+            wilton::support::check_json_callback_script(script_field);
+        }
+    });
+    auto dyload_chain = measure(runs_hint, [&] {
+        for (size_t i = 0; i < iterations; i++) {
+            wilton::support::json_cursor cur{dyload_span};
+            cur.enter_object();
+            while (cur.next_field()) {
+                if ("name" == cur.key()) {
+                    name = cur.read_string_nonempty(cur.key());
+                } else if ("directory" == cur.key()) {
+                    directory = cur.read_string_nonempty(cur.key());
+                } else {
+                    throw std::runtime_error(cur.key());
+                }
+            }
+            cur.finish();
+        }
+    });
+    auto dyload_schema_time = measure(runs_hint, [&] {
+        for (size_t i = 0; i < iterations; i++) {
+            wilton::support::json_cursor cur{dyload_span};
+            dyload_schema.read_object(cur, [&](size_t idx, const std::string& key) {
+                switch (idx) {
+                case 0: name = cur.read_string_nonempty(key); break;
+                case 1: directory = cur.read_string_nonempty(key); break;
+                }
+            });
+            cur.finish();
+        }
+    });
+    std::printf("\n%-24s %12s %12s %12s\n", "field checks", "iterations", "chain, us", "schema, us");
+    std::printf("%-24s %12zu %12llu %12llu\n", "callback script", iterations,
+            static_cast<unsigned long long>(script_chain), static_cast<unsigned long long>(script_schema));
+    std::printf("%-24s %12zu %12llu %12llu\n", "dyload arguments", iterations,
+            static_cast<unsigned long long>(dyload_chain), static_cast<unsigned long long>(dyload_schema_time));
+}
+
+#ifdef WILTON_BENCH_ENGINE_MAP
+
+void spin_micros(uint64_t micros) {
+    auto start = now_micros();
+    while (now_micros() - start < micros) { }
+}
+
+// stands for a script engine: construction evaluates the init
+// code and the first call loads the module it calls
+class bench_engine {
+    bool module_loaded = false;
+
+public:
+    explicit bench_engine(sl::io::span<const char>) {
+        spin_micros(20000);
+    }
+
+    wilton::support::buffer run_callback_script(sl::io::span<const char>) {
+        if (!module_loaded) {
+            spin_micros(5000);
+            module_loaded = true;
+        }
+        return wilton::support::make_empty_buffer();
+    }
+
+    // can be built on the pool warm-up threads
+    static bool thread_agile() {
+        return true;
+    }
+};
+
+// times from the start until each of the threads got its first response, sorted
+std::vector<uint64_t> first_responses(size_t threads_count, const std::function<void()>& first_call) {
+    std::atomic<bool> started{false};
+    auto times = std::vector<uint64_t>(threads_count);
+    auto threads = std::vector<std::thread>();
+    for (size_t i = 0; i < threads_count; i++) {
+        threads.emplace_back([&started, &times, &first_call, i] {
+            while (!started.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            first_call();
+            times[i] = now_micros();
+        });
+    }
+    auto start = now_micros();
+    started.store(true, std::memory_order_release);
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (auto& ti : times) {
+        ti -= start;
+    }
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+void bench_first_request() {
+    const size_t threads_count = 32;
+    auto code = std::string("/* wilton-require.js */");
+    auto code_span = sl::io::make_span(code.data(), code.length());
+    auto script = std::string("{\"module\": \"app/handlers/orders\", \"func\": \"list\"}");
+    auto script_span = sl::io::make_span(script.data(), script.length());
+
+    // engines created by the map on the first call of each thread
+    wilton::support::script_engine_map<bench_engine> map{[code_span] {
+        return code_span;
+    }};
+    auto cold = first_responses(threads_count, [&] {
+        map.run_script(script_span);
+    });
+
+    // engines built and warmed up at startup
+    wilton::support::engine_pool<bench_engine> pool;
+    auto warmup_start = now_micros();
+    pool.warm_up(threads_count, [&] {
+        return bench_engine(code_span);
+    }, std::vector<std::string>{script});
+    auto warmup = now_micros() - warmup_start;
+    if (threads_count != pool.size()) {
+        throw std::runtime_error("Engine pool not filled, size: [" + sl::support::to_string(pool.size()) + "]");
+    }
+    auto warm = first_responses(threads_count, [&] {
+        pool.take([&](bench_engine&& en) {
+            en.run_callback_script(script_span);
+        });
+    });
+
+    std::printf("\n%-24s %12s %12s %12s %12s\n", "time to first request", "warm-up, us",
+            "first, us", "median, us", "last, us");
+    std::printf("%-24s %12s %12llu %12llu %12llu\n", "engine per thread", "-",
+            static_cast<unsigned long long>(cold.front()),
+            static_cast<unsigned long long>(cold[cold.size() / 2]),
+            static_cast<unsigned long long>(cold.back()));
+    std::printf("%-24s %12llu %12llu %12llu %12llu\n", "warm pool",
+            static_cast<unsigned long long>(warmup),
+            static_cast<unsigned long long>(warm.front()),
+            static_cast<unsigned long long>(warm[warm.size() / 2]),
+            static_cast<unsigned long long>(warm.back()));
+}
+
+#endif // WILTON_BENCH_ENGINE_MAP
+
+} // namespace
+
+int main() {
+    auto sizes = std::vector<size_t>{1u << 10, 64u << 10, 1u << 20, 16u << 20, 100u << 20};
+    bench_cursor(sizes);
+    bench_transcode(sizes);
+    bench_schema();
+#ifdef WILTON_BENCH_ENGINE_MAP
+    bench_first_request();
+#endif // WILTON_BENCH_ENGINE_MAP
+    return 0;
+}
@@ -0,0 +1,644 @@
+/*
+ * File:   wilton_core_test.cpp
+ * Author: alex
+ *
+ * Created on October 20, 2026, 10:05 AM
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "call/call_registry.hpp"
+#include "call/result_cache.hpp"
+#include "json/block_classifier.hpp"
+
+#include "wilton/support/buffer.hpp"
+#include "wilton/support/json_schema.hpp"
+#include "wilton/support/json_view.hpp"
+#include "wilton/support/registrar.hpp"
+
+namespace { // anonymous
+
+void check(bool cond, const char* msg) {
+    if (!cond) {
+        std::printf("check failed: %s\n", msg);
+        std::exit(1);
+    }
+}
+
+char* noop_call(void*, const char*, int, char**, int*) {
+    return nullptr;
+}
+
+int64_t json_int(const sl::json::value& val, const std::string& name) {
+    return val.getattr(name).as_int64();
+}
+
+bool cache_get(wilton::call::result_cache& cache, uint64_t hash, const std::string& payload) {
+    char* out = nullptr;
+    int out_len = 0;
+    auto res = cache.get(hash, payload.data(), payload.length(), std::addressof(out), std::addressof(out_len));
+    wilton_free(out);
+    return res;
+}
+
+void cache_put(wilton::call::result_cache& cache, uint64_t hash, const std::string& payload) {
+    cache.put(hash, payload.data(), payload.length(), "{}", 2);
+}
+
+sl::json::value into_result() {
+    return {
+        { "foo", 42 }
+    };
+}
+
+// builds and frees an intermediate buffer before the result
+wilton::support::buffer into_call(sl::io::span<const char>) {
+    auto tmp = wilton::support::make_json_buffer({
+        { "tmp", true }
+    });
+    wilton_free(tmp.value().data());
+    return wilton::support::make_json_result(into_result());
+}
+
+// result not created with the result helpers is copied
+wilton::support::buffer into_call_copied(sl::io::span<const char>) {
+    return wilton::support::make_string_buffer("{\"bar\":1}");
+}
+
+// builds the index through the C API, returns the error message, empty on success
+std::string index_json(wilton_JsonIndex* index, const std::string& json) {
+    auto err = wilton_json_index_build(index, json.data(), static_cast<int>(json.length()));
+    if (nullptr == err) {
+        return std::string();
+    }
+    auto res = std::string(err);
+    wilton_free(err);
+    return res;
+}
+
+int index_count(wilton_JsonIndex* index, const int** offsets, const int** next) {
+    int count = -1;
+    auto err = wilton_json_index_get(index, offsets, next, std::addressof(count));
+    check(nullptr == err, "index get succeeded");
+    return count;
+}
+
+bool masks_equal(const wilton::json::block_masks& a, const wilton::json::block_masks& b) {
+    return a.backslash == b.backslash && a.quote == b.quote && a.op == b.op &&
+            a.ws == b.ws && a.control == b.control;
+}
+
+// checks that the call throws and that the message contains 'error'
+template<typename Fun>
+void check_throws(Fun fun, const std::string& error, const char* msg) {
+    try {
+        fun();
+    } catch (const wilton::support::exception& e) {
+        check(std::string::npos != std::string(e.what()).find(error), msg);
+        return;
+    }
+    check(false, msg);
+}
+
+// same hash as in json_schema, used to pick names that collide in its table
+uint32_t schema_hash(const std::string& name, uint32_t seed) {
+    uint32_t res = 2166136261u ^ seed;
+    for (char ch : name) {
+        res ^= static_cast<uint8_t>(ch);
+        res *= 16777619u;
+    }
+    return res ^ (res >> 15);
+}
+
+int64_t cursor_int64(const std::string& json) {
+    wilton::support::json_cursor cur{sl::io::make_span(json.data(), json.length())};
+    auto res = cur.read_int64();
+    cur.finish();
+    return res;
+}
+
+double cursor_double(const std::string& json) {
+    wilton::support::json_cursor cur{sl::io::make_span(json.data(), json.length())};
+    auto res = cur.read_double();
+    cur.finish();
+    return res;
+}
+
+std::string cursor_string(const std::string& json) {
+    wilton::support::json_cursor cur{sl::io::make_span(json.data(), json.length())};
+    auto res = cur.read_string();
+    cur.finish();
+    return res;
+}
+
+} // namespace
+
+// writers churn entries while readers resolve both the stable
+// and the churned names, snapshots must stay valid for readers
+void test_registry_concurrent() {
+    wilton::call::call_registry reg;
+    reg.put("stable", nullptr, noop_call);
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&reg, &stop, t] {
+            const char* names[] = {"stable", "churn_0", "churn_1", ""};
+            int lens[] = {6, 7, 7, 0};
+            auto found = std::vector<std::shared_ptr<wilton::call::call_entry>>();
+            while (!stop.load()) {
+                auto en = reg.find("stable");
+                check(nullptr != en.get() && "stable" == en->name, "stable entry found");
+                auto churned = reg.find(0 == t % 2 ? "churn_0" : "churn_1");
+                check(nullptr == churned.get() || 7 == churned->name.length(), "churned entry intact");
+                found.clear();
+                reg.find_all(names, lens, 4, found);
+                check(4 == found.size(), "find_all size");
+                check(nullptr != found[0].get() && "stable" == found[0]->name, "find_all stable entry");
+                check(nullptr == found[3].get(), "find_all empty name");
+                std::this_thread::yield();
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++) {
+        writers.emplace_back([&reg, t] {
+            auto name = std::string("churn_") + std::to_string(t);
+            for (int i = 0; i < 20000; i++) {
+                reg.put(name, nullptr, noop_call);
+                reg.remove(name);
+            }
+        });
+    }
+    for (auto& th : writers) {
+        th.join();
+    }
+    stop.store(true);
+    for (auto& th : readers) {
+        th.join();
+    }
+    check(nullptr == reg.find("churn_0").get(), "churned entry removed");
+}
+
+void test_cache_bound() {
+    wilton::call::result_cache single{"single", 0, 1};
+    for (uint64_t i = 0; i < 50; i++) {
+        cache_put(single, i, "{}");
+    }
+    auto st = single.to_json();
+    check(1 == json_int(st, "size"), "single entry cache size");
+    check(49 == json_int(st, "evictions"), "single entry cache evictions");
+
+    wilton::call::result_cache small{"small", 0, 20};
+    for (uint64_t i = 0; i < 1000; i++) {
+        cache_put(small, i, "{}");
+    }
+    check(20 == json_int(small.to_json(), "size"), "cache size is bound by max entries");
+}
+
+void test_cache_lru() {
+    // 16 shards, 2 entries each, hashes below fall into the same shard
+    wilton::call::result_cache cache{"lru", 0, 32};
+    cache_put(cache, 0, "a");
+    cache_put(cache, 16, "b");
+    check(cache_get(cache, 0, "a"), "first entry hit");
+    cache_put(cache, 32, "c");
+    check(cache_get(cache, 0, "a"), "recently used entry kept");
+    check(!cache_get(cache, 16, "b"), "least recently used entry evicted");
+    check(cache_get(cache, 32, "c"), "new entry hit");
+    check(!cache_get(cache, 32, "x"), "payload mismatch is a miss");
+    auto st = cache.to_json();
+    check(3 == json_int(st, "hits"), "lru hits");
+    check(2 == json_int(st, "misses"), "lru misses");
+    check(1 == json_int(st, "evictions"), "lru evictions");
+}
+
+void test_cache_ttl() {
+    wilton::call::result_cache cache{"ttl", 20, 16};
+    cache_put(cache, 1, "a");
+    check(cache_get(cache, 1, "a"), "entry hit before TTL");
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    check(!cache_get(cache, 1, "a"), "entry expired after TTL");
+    auto st = cache.to_json();
+    check(1 == json_int(st, "evictions"), "expired entry evicted");
+    check(0 == json_int(st, "size"), "expired entry removed");
+}
+
+void test_into_intermediate_buffer() {
+    auto fun = reinterpret_cast<void*> (into_call);
+    auto expected = into_result().dumps();
+    char buf[64];
+    int len = -1;
+    auto err = wilton::support::detail_registrar::cb_fun_into(fun, "{}", 2, buf, sizeof(buf), std::addressof(len));
+    check(nullptr == err, "into call succeeded");
+    check(expected.length() == static_cast<size_t> (len), "into result length");
+    check(0 == std::memcmp(expected.data(), buf, expected.length()), "into result written to caller buffer");
+
+    // too small buffer, full length is reported
+    char small[4];
+    len = -1;
+    err = wilton::support::detail_registrar::cb_fun_into(fun, "{}", 2, small, sizeof(small), std::addressof(len));
+    check(nullptr == err, "into call with small buffer succeeded");
+    check(expected.length() == static_cast<size_t> (len), "into result length with small buffer");
+
+    auto copied = std::string("{\"bar\":1}");
+    len = -1;
+    err = wilton::support::detail_registrar::cb_fun_into(reinterpret_cast<void*> (into_call_copied),
+            "{}", 2, buf, sizeof(buf), std::addressof(len));
+    check(nullptr == err, "into call with copied result succeeded");
+    check(copied.length() == static_cast<size_t> (len), "copied result length");
+    check(0 == std::memcmp(copied.data(), buf, copied.length()), "copied result written to caller buffer");
+
+    // target is not left behind for the calls outside of 'wiltoncall_into'
+    check(nullptr == wilton::support::detail_buffer::current_into_target(), "into target reset");
+}
+
+// SIMD classifiers must produce the same masks as the scalar one,
+// bytes are biased towards the classified characters
+void test_json_classifiers() {
+    const std::string special = "\\\"{}[]:, \t\n\r\x01\x1f\x20\x7f\x80\xff[{az0";
+    std::mt19937 rng{42};
+    char block[wilton::json::block_size];
+    for (int i = 0; i < 10000; i++) {
+        for (size_t j = 0; j < sizeof(block); j++) {
+            auto rnd = rng();
+            block[j] = 0 == rnd % 2 ? special[(rnd >> 1) % special.length()] : static_cast<char>(rnd >> 8);
+        }
+        wilton::json::block_masks expected;
+        wilton::json::classify_scalar(block, expected);
+#ifdef WILTON_JSON_X86_SIMD
+        wilton::json::block_masks masks;
+        wilton::json::classify_sse2(block, masks);
+        check(masks_equal(expected, masks), "SSE2 masks match scalar masks");
+        if (wilton::json::avx2_supported()) {
+            wilton::json::classify_avx2(block, masks);
+            check(masks_equal(expected, masks), "AVX2 masks match scalar masks");
+        }
+#endif // WILTON_JSON_X86_SIMD
+    }
+}
+
+// odd runs escape the quote after them, runs cross the block edges
+void test_json_index_backslashes() {
+    wilton_JsonIndex* index = nullptr;
+    check(nullptr == wilton_json_index_create(std::addressof(index)), "index created");
+    const size_t runs[] = {1, 2, 3, 4, 5, 6, 7, 8, 63, 64, 65, 129};
+    for (size_t run : runs) {
+        for (size_t pad = 50; pad <= 70; pad++) {
+            auto json = "[\"" + std::string(pad, 'a') + std::string(run, '\\') +
+                    (1 == run % 2 ? "\"" : "") + "\",1]";
+            check(index_json(index, json).empty(), "string with backslashes indexed");
+            const int* offsets = nullptr;
+            const int* next = nullptr;
+            check(5 == index_count(index, std::addressof(offsets), std::addressof(next)), "backslashes entries count");
+            check(static_cast<int>(json.length() - 3) == offsets[2], "string closed after backslashes");
+            check(5 == next[0], "array closed after backslashes");
+
+            wilton::support::json_view view{sl::io::make_span(json.data(), json.length()), offsets, next, 5};
+            auto expected = std::string(pad, 'a') + std::string(run / 2, '\\') + (1 == run % 2 ? "\"" : "");
+            check(expected == view.root()[0].as_string_or_throw(), "string with backslashes unescaped");
+        }
+    }
+    wilton_json_index_destroy(index);
+}
+
+void test_json_index_invalid() {
+    wilton_JsonIndex* index = nullptr;
+    check(nullptr == wilton_json_index_create(std::addressof(index)), "index created");
+    struct invalid_input {
+        std::string json;
+        const char* error;
+    };
+    const invalid_input inputs[] = {
+        // unterminated strings
+        {"\"abc", "Unterminated string"},
+        {"{\"a\":\"b\\\"}", "Unterminated string"},
+        {"[\"" + std::string(100, 'a'), "Unterminated string"},
+        // mismatched and unclosed brackets
+        {"[1,2}", "Mismatched bracket"},
+        {"{\"a\":1]", "Mismatched bracket"},
+        {"[[1]", "Unexpected end of input"},
+        {"{\"a\":1}}", "Unexpected trailing data"},
+        {"]", "Unexpected character"},
+        {"{1:2}", "Expected field name"},
+        {"{\"a\" 1}", "Expected: [:]"},
+        {"[1 2]", "Unexpected character"},
+        {"", "Empty input"},
+        // bad scalars
+        {"tru", "Invalid value"},
+        {"nulls", "Invalid value"},
+        {"[01]", "Invalid value"},
+        {"[1.]", "Invalid value"},
+        {"-", "Invalid value"},
+        {"+1", "Invalid value"},
+        {"1e", "Invalid value"},
+        {"0x10", "Invalid value"},
+        {"[1,\x01]", "Invalid value"},
+        // raw control characters in strings
+        {std::string("\"a\x01", 3) + "b\"", "Unescaped control character"},
+        {"[\"a\nb\"]", "Unescaped control character"},
+        {"[\"" + std::string(70, 'a') + "\t\"]", "Unescaped control character"}
+    };
+    for (auto& in : inputs) {
+        auto err = index_json(index, in.json);
+        check(std::string::npos != err.find(in.error), in.error);
+        const int* offsets = nullptr;
+        const int* next = nullptr;
+        check(0 == index_count(index, std::addressof(offsets), std::addressof(next)), "no partial index left");
+    }
+    check(index_json(index, "[1, true, null, -0.5e+3]").empty(), "index reused after errors");
+    wilton_json_index_destroy(index);
+}
+
+void test_json_view() {
+    auto json = std::string("{\"name\": \"foo\", \"nested\" : {\"arr\": [1, 2.5, {\"deep\": true}] ,"
+            " \"esc\\\"key\": \"v\"}, \"empty\": {}, \"list\": [], \"n\": null, \"neg\": -42 }\n");
+    wilton_JsonIndex* index = nullptr;
+    check(nullptr == wilton_json_index_create(std::addressof(index)), "index created");
+    check(index_json(index, json).empty(), "view input indexed");
+    const int* offsets = nullptr;
+    const int* next = nullptr;
+    auto count = index_count(index, std::addressof(offsets), std::addressof(next));
+    wilton::support::json_view view{sl::io::make_span(json.data(), json.length()), offsets, next, count};
+    auto root = view.root();
+
+    check("foo" == root["name"].as_string_or_throw(), "string field");
+    check(2.5 == root["nested"]["arr"][1].as_double_or_throw(), "real element");
+    check(1 == root["nested"]["arr"][0].as_int64_or_throw(), "integer element");
+    check(root["nested"]["arr"][2]["deep"].as_bool_or_throw(), "field of nested object");
+    check("v" == root["nested"]["esc\"key"].as_string_or_throw(), "escaped key");
+    check(-42 == root["neg"].as_int64_or_throw(), "field after nulls and empty containers");
+    check(root["n"].exists() && sl::json::type::nullt == root["n"].json_type(), "null field");
+    auto arr = root["nested"]["arr"].raw();
+    check("[1, 2.5, {\"deep\": true}]" == std::string(arr.data(), arr.size()), "raw value without trailing whitespace");
+
+    // missing values
+    check(!root["missing"].exists(), "missing field");
+    check(!root["nested"]["arr"][3].exists(), "out of range element");
+    check(!root["name"]["x"].exists(), "field of a string");
+    check(!root["name"][0].exists(), "element of a string");
+    check(!root["missing"]["x"].exists(), "field of a missing value");
+
+    // sizes and iteration
+    check(6 == root.size(), "object size");
+    check(0 == root["empty"].size() && 0 == root["list"].size(), "empty containers size");
+    auto keys = std::string();
+    root.for_each_field([&keys](const std::string& key, const wilton::support::json_node&) {
+        keys += key + ",";
+    });
+    check("name,nested,empty,list,n,neg," == keys, "fields iterated in order");
+    size_t elements = 0;
+    root["nested"]["arr"].for_each_element([&elements](const wilton::support::json_node&) {
+        elements += 1;
+    });
+    check(3 == elements, "elements iterated");
+
+    bool thrown = false;
+    try {
+        root["name"].as_int64_or_throw("name");
+    } catch (const wilton::support::exception&) {
+        thrown = true;
+    }
+    check(thrown, "type mismatch reported");
+    wilton_json_index_destroy(index);
+}
+
+void test_json_schema_validate() {
+    namespace ws = wilton::support;
+    check_throws([] {
+        ws::make_json_schema(
+                ws::required_field("name", ws::field_kind::string),
+                ws::optional_field("name", ws::field_kind::integer));
+    }, "Invalid duplicate schema field: [name]", "duplicate field rejected");
+
+    auto schema = ws::make_json_schema(
+            ws::required_field("name", ws::field_kind::string_nonempty),
+            ws::optional_field("count", ws::field_kind::integer),
+            ws::optional_field("ratio", ws::field_kind::real));
+    sl::json::value valid = {
+        { "name", "foo" },
+        { "ratio", 1 }
+    };
+    schema.validate(valid.as_object(), "valid");
+
+    sl::json::value unknown = {
+        { "name", "foo" },
+        { "extra", true }
+    };
+    check_throws([&] {
+        schema.validate(unknown.as_object(), "obj");
+    }, "Unknown data field: [extra] in object: [obj]", "unknown field rejected");
+    sl::json::value missing = {
+        { "count", 1 }
+    };
+    check_throws([&] {
+        schema.validate(missing.as_object(), "obj");
+    }, "Required field: 'name' is not supplied", "missing required field rejected");
+    sl::json::value mismatch = {
+        { "name", "foo" },
+        { "count", "1" }
+    };
+    check_throws([&] {
+        schema.validate(mismatch.as_object(), "obj");
+    }, "Invalid 'count' field", "kind mismatch rejected");
+    sl::json::value empty = {
+        { "name", "" }
+    };
+    check_throws([&] {
+        schema.validate(empty.as_object(), "obj");
+    }, "Invalid 'name' field", "empty string rejected");
+}
+
+void test_json_schema_read_object() {
+    namespace ws = wilton::support;
+    static const auto schema = ws::make_json_schema(
+            ws::required_field("name", ws::field_kind::string_nonempty),
+            ws::optional_field("count", ws::field_kind::integer));
+    auto read = [](const std::string& json) {
+        ws::json_cursor cur{sl::io::make_span(json.data(), json.length())};
+        auto name = std::string();
+        int64_t count = 0;
+        schema.read_object(cur, [&](size_t idx, const std::string& key) {
+            switch (idx) {
+            case 0: name = cur.read_string_nonempty(key); break;
+            case 1: count = cur.read_int64(); break;
+            }
+        }, "obj");
+        cur.finish();
+        return name + ":" + sl::support::to_string(count);
+    };
+    check("foo:2" == read("{\"count\": 2, \"name\": \"foo\"}"), "object read");
+    check_throws([&] {
+        read("{\"name\": \"foo\", \"extra\": 1}");
+    }, "Unknown data field: [extra] in object: [obj]", "unknown field rejected by reader");
+    check_throws([&] {
+        read("{\"count\": 2}");
+    }, "Required field: 'name' is not supplied in object: [obj]", "missing required field rejected by reader");
+    check_throws([&] {
+        read("{\"name\": \"foo\", \"count\": 2.5}");
+    }, "Invalid 'count' field", "kind mismatch rejected by reader");
+    check_throws([&] {
+        read("{\"name\": \"\"}");
+    }, "Invalid empty string value for field: [name]", "empty string rejected by reader");
+}
+
+// names that collide modulo the table for the initial seed are still
+// found, names that are not in the schema are never found
+void test_json_schema_find() {
+    namespace ws = wilton::support;
+    auto colliding = std::string();
+    for (int i = 0; colliding.empty(); i++) {
+        auto name = "k" + sl::support::to_string(i);
+        if ((schema_hash(name, 0) & 3) == (schema_hash("a", 0) & 3)) {
+            colliding = name;
+        }
+    }
+    auto pair = ws::make_json_schema(
+            ws::required_field("a", ws::field_kind::any),
+            ws::required_field(colliding.c_str(), ws::field_kind::any));
+    check(0 == pair.find("a") && 1 == pair.find(colliding), "colliding names found");
+
+    auto wide = ws::make_json_schema(
+            ws::optional_field("f0", ws::field_kind::any), ws::optional_field("f1", ws::field_kind::any),
+            ws::optional_field("f2", ws::field_kind::any), ws::optional_field("f3", ws::field_kind::any),
+            ws::optional_field("f4", ws::field_kind::any), ws::optional_field("f5", ws::field_kind::any),
+            ws::optional_field("f6", ws::field_kind::any), ws::optional_field("f7", ws::field_kind::any),
+            ws::optional_field("f8", ws::field_kind::any), ws::optional_field("f9", ws::field_kind::any),
+            ws::optional_field("f10", ws::field_kind::any), ws::optional_field("f11", ws::field_kind::any),
+            ws::optional_field("f12", ws::field_kind::any), ws::optional_field("f13", ws::field_kind::any),
+            ws::optional_field("f14", ws::field_kind::any), ws::optional_field("f15", ws::field_kind::any));
+    // 16 names in 32 slots, at least one pair collides for the initial seed
+    uint32_t used = 0;
+    bool collides = false;
+    for (int i = 0; i < 16; i++) {
+        auto bit = static_cast<uint32_t>(1) << (schema_hash("f" + sl::support::to_string(i), 0) & 31);
+        collides = collides || 0 != (used & bit);
+        used |= bit;
+    }
+    check(collides, "initial seed collides");
+    for (int i = 0; i < 16; i++) {
+        check(i == wide.find("f" + sl::support::to_string(i)), "all names found");
+    }
+
+    // unknown names land on the occupied slots too
+    for (int i = 0; i < 1000; i++) {
+        auto name = "x" + sl::support::to_string(i);
+        check(-1 == pair.find(name) && -1 == wide.find(name), "unknown name not found");
+    }
+    check(-1 == pair.find("") && -1 == wide.find("f"), "prefix not found");
+    check(-1 == wide.find("f16") && -1 == wide.find("f01"), "similar name not found");
+}
+
+void test_json_cursor_int64() {
+    check(INT64_MAX == cursor_int64("9223372036854775807"), "max int64 read");
+    check(INT64_MIN == cursor_int64("-9223372036854775808"), "min int64 read");
+    check(0 == cursor_int64("-0") && 0 == cursor_int64("0"), "zero read");
+    const char* overflows[] = {"9223372036854775808", "-9223372036854775809",
+            "18446744073709551616", "99999999999999999999"};
+    for (auto in : overflows) {
+        check_throws([in] { cursor_int64(in); }, "Integer value overflow", "int64 overflow rejected");
+    }
+    const char* invalid[] = {"01", "-01", "-", "1.5", "1e3", "+1", "0x10", "\"1\""};
+    for (auto in : invalid) {
+        check_throws([in] { cursor_int64(in); }, "Invalid integer value", "invalid integer rejected");
+    }
+}
+
+void test_json_cursor_double() {
+    check(0.5 == cursor_double("0.5"), "fraction read");
+    check(-1000.0 == cursor_double("-1e3"), "exponent read");
+    check(0.01 == cursor_double("1E-2"), "negative exponent read");
+    check(42.0 == cursor_double("42"), "integer read as double");
+    // accepted by 'strtod', but not by JSON grammar
+    const char* invalid[] = {"0x10", "0x1p3", "inf", "-inf", "Infinity", "nan", "01", "-01",
+            "00.5", "1.", ".5", "+1", "1e", "1e+", "-"};
+    for (auto in : invalid) {
+        check_throws([in] { cursor_double(in); }, "Invalid number value", "invalid number rejected");
+    }
+    check_throws([] { cursor_double("1e999"); }, "Invalid number value", "out of range number rejected");
+}
+
+void test_json_cursor_unicode() {
+    check("\xC3\xA9" == cursor_string("\"\\u00e9\""), "two-byte escape");
+    check("\xE2\x82\xAC" == cursor_string("\"\\u20AC\""), "three-byte escape");
+    check("\xF0\x9F\x98\x80" == cursor_string("\"\\ud83d\\ude00\""), "surrogate pair");
+    check("a\xF0\x9F\x98\x80z" == cursor_string("\"a\\uD83D\\uDE00z\""), "surrogate pair inside string");
+    const char* lone[] = {"\"\\ud83d\"", "\"\\ud83dx\"", "\"\\ud83d\\u0041\"", "\"\\ud83d\\ud83d\"",
+            "\"\\ude00\"", "\"\\ude00\\ud83d\""};
+    for (auto in : lone) {
+        check_throws([in] { cursor_string(in); }, "Invalid unicode surrogate pair", "lone surrogate rejected");
+    }
+    check_throws([] { cursor_string("\"\\ud8zz\""); }, "Invalid unicode escape", "invalid hex escape rejected");
+}
+
+void test_json_cursor_skip() {
+    auto json = std::string("{\"a\": [1, {\"b\": \"x\\\"]}\"}, \"\\\\\", [[\"\\\"[\"]]],"
+            " \"s\": \"}\\\"{\", \"c\": 2}");
+    wilton::support::json_cursor cur{sl::io::make_span(json.data(), json.length())};
+    cur.enter_object();
+    check(cur.next_field() && "a" == cur.key(), "first field");
+    cur.skip();
+    check(cur.next_field() && "s" == cur.key(), "field after nested containers");
+    cur.skip();
+    check(cur.next_field() && "c" == cur.key(), "field after string with brackets");
+    check(2 == cur.read_int64(), "value after skipped fields");
+    check(!cur.next_field(), "object closed");
+    cur.finish();
+
+    auto unclosed = std::string("[{\"a\": \"]\\\"}\"}");
+    check_throws([&unclosed] {
+        wilton::support::json_cursor uc{sl::io::make_span(unclosed.data(), unclosed.length())};
+        uc.skip();
+    }, "Unexpected end of input", "unclosed container not skipped");
+}
+
+void test_json_cursor_finish() {
+    check_throws([] { cursor_int64("1 2"); }, "Unexpected trailing data", "trailing value rejected");
+    check_throws([] { cursor_string("\"a\","); }, "Unexpected trailing data", "trailing comma rejected");
+    auto json = std::string("{\"a\": [1");
+    check_throws([&json] {
+        wilton::support::json_cursor cur{sl::io::make_span(json.data(), json.length())};
+        cur.enter_object();
+        cur.next_field();
+        cur.enter_array();
+        cur.next_element();
+        cur.read_int64();
+        cur.finish();
+    }, "Unclosed object or array", "unclosed container rejected");
+    auto closed = std::string(" {\"a\": []} \n");
+    wilton::support::json_cursor cur{sl::io::make_span(closed.data(), closed.length())};
+    cur.enter_object();
+    cur.next_field();
+    cur.enter_array();
+    check(!cur.next_element() && !cur.next_field(), "containers closed");
+    cur.finish();
+}
+
+int main() {
+    test_registry_concurrent();
+    test_cache_bound();
+    test_cache_lru();
+    test_cache_ttl();
+    test_into_intermediate_buffer();
+    test_json_classifiers();
+    test_json_index_backslashes();
+    test_json_index_invalid();
+    test_json_view();
+    test_json_schema_validate();
+    test_json_schema_read_object();
+    test_json_schema_find();
+    test_json_cursor_int64();
+    test_json_cursor_double();
+    test_json_cursor_unicode();
+    test_json_cursor_skip();
+    test_json_cursor_finish();
+
+    return 0;
+}
@@ -0,0 +1,400 @@
+/*
+ * File:   wilton_engine_map_test.cpp
+ * Author: alex
+ *
+ * Created on October 21, 2026, 11:40 AM
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "wilton/support/script_engine_map.hpp"
+
+namespace { // anonymous
+
+void check(bool cond, const char* msg) {
+    if (!cond) {
+        std::printf("check failed: %s\n", msg);
+        std::exit(1);
+    }
+}
+
+std::atomic<int> engines_created{0};
+
+// returns its id from every call
+class test_engine {
+    int id;
+
+public:
+    explicit test_engine(sl::io::span<const char>) :
+    id(engines_created.fetch_add(1) + 1) { }
+
+    wilton::support::buffer run_callback_script(sl::io::span<const char>) {
+        return wilton::support::make_string_buffer(sl::support::to_string(id));
+    }
+};
+
+// can be built on the pool warm-up threads
+class agile_engine : public test_engine {
+public:
+    explicit agile_engine(sl::io::span<const char> code) :
+    test_engine(code) { }
+
+    static bool thread_agile() {
+        return true;
+    }
+};
+
+std::atomic<bool> block_entered{false};
+std::atomic<bool> block_released{false};
+
+// reports a fixed heap, '"block"' calls wait for the release
+class heap_engine : public agile_engine {
+public:
+    explicit heap_engine(sl::io::span<const char> code) :
+    agile_engine(code) { }
+
+    wilton::support::buffer run_callback_script(sl::io::span<const char> script) {
+        if (std::string(script.data(), script.size()) == "\"block\"") {
+            block_entered.store(true);
+            while (!block_released.load()) {
+                std::this_thread::yield();
+            }
+        }
+        return agile_engine::run_callback_script(script);
+    }
+
+    uint64_t heap_size() const {
+        return 100;
+    }
+};
+
+// reports a heap, but is bound to its thread
+class bound_heap_engine : public test_engine {
+public:
+    explicit bound_heap_engine(sl::io::span<const char> code) :
+    test_engine(code) { }
+
+    uint64_t heap_size() const {
+        return 100;
+    }
+};
+
+std::atomic<int> gcs_incremental{0};
+std::atomic<int> gcs_full{0};
+std::atomic<bool> gc_entered{false};
+std::atomic<bool> gc_released{true};
+// set while the engine is used, by a call or by GC
+std::atomic<bool> gc_engine_used{false};
+
+// records collections, GC waits for the release when it is not set
+class gc_engine : public agile_engine {
+public:
+    explicit gc_engine(sl::io::span<const char> code) :
+    agile_engine(code) { }
+
+    wilton::support::buffer run_callback_script(sl::io::span<const char> script) {
+        check(!gc_engine_used.exchange(true), "engine is not used concurrently by call");
+        auto res = agile_engine::run_callback_script(script);
+        gc_engine_used.store(false);
+        return res;
+    }
+
+    void collect_garbage(bool full) {
+        check(!gc_engine_used.exchange(true), "engine is not used concurrently by GC");
+        gc_entered.store(true);
+        while (!gc_released.load()) {
+            std::this_thread::yield();
+        }
+        (full ? gcs_full : gcs_incremental).fetch_add(1);
+        gc_engine_used.store(false);
+    }
+};
+
+// collects garbage, but is bound to its thread
+class bound_gc_engine : public test_engine {
+public:
+    explicit bound_gc_engine(sl::io::span<const char> code) :
+    test_engine(code) { }
+
+    void collect_garbage(bool full) {
+        (full ? gcs_full : gcs_incremental).fetch_add(1);
+    }
+};
+
+// runs tasks on its own thread, so engines of different threads can be driven in order
+class worker {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::function<void()> task;
+    bool stop = false;
+    std::thread th;
+
+public:
+    worker() :
+    th([this] { this->loop(); }) { }
+
+    ~worker() {
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            stop = true;
+        }
+        cv.notify_all();
+        th.join();
+    }
+
+    void post(std::function<void()> fun) {
+        std::lock_guard<std::mutex> guard{mutex};
+        task = std::move(fun);
+        cv.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> guard{mutex};
+        cv.wait(guard, [this] { return !task; });
+    }
+
+    void run(std::function<void()> fun) {
+        post(std::move(fun));
+        wait();
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> guard{mutex};
+        for (;;) {
+            cv.wait(guard, [this] { return stop || task; });
+            if (stop) {
+                return;
+            }
+            guard.unlock();
+            task();
+            guard.lock();
+            task = nullptr;
+            cv.notify_all();
+        }
+    }
+};
+
+void next_millis() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+sl::io::span<const char> init_code() {
+    static const std::string code = "init";
+    return sl::io::make_span(code.data(), code.length());
+}
+
+template<typename Map>
+int run_id(Map& map, const std::string& script = "{}") {
+    auto out = map.run_script(sl::io::make_span(script.data(), script.length()));
+    check(static_cast<bool>(out), "script result returned");
+    auto res = std::atoi(std::string(out.value().data(), out.value().size()).c_str());
+    wilton_free(out.value().data());
+    return res;
+}
+
+std::string current_tid() {
+    return sl::support::to_string_any(std::this_thread::get_id());
+}
+
+} // namespace
+
+// engine pointer cached by the thread must not be used after clean
+void test_generation_clean() {
+    wilton::support::script_engine_map<test_engine> map{init_code};
+    auto first = run_id(map);
+    check(first == run_id(map), "cached engine reused");
+    auto tid = current_tid();
+    map.clean_thread_local(tid.c_str(), static_cast<int>(tid.length()));
+    auto second = run_id(map);
+    check(first != second, "engine recreated after clean");
+    check(second == run_id(map), "recreated engine cached");
+
+    // clean of another thread invalidates the cache, but keeps this engine
+    auto other = std::string("other");
+    map.clean_thread_local(other.c_str(), static_cast<int>(other.length()));
+    check(second == run_id(map), "engine kept after clean of another thread");
+    check(2 == map.stats()["creations"].as_int64(), "engine creations");
+}
+
+void test_pool_agile() {
+    auto scripts = std::vector<std::string>();
+    wilton::support::engine_pool<test_engine> bound;
+    bound.warm_up(4, [] {
+        return test_engine(init_code());
+    }, scripts);
+    check(0 == bound.size(), "engines bound to threads are not pooled");
+
+    wilton::support::engine_pool<agile_engine> agile;
+    agile.warm_up(4, [] {
+        return agile_engine(init_code());
+    }, scripts);
+    check(4 == agile.size(), "agile engines pooled");
+    auto taken = agile.take([](agile_engine&&) { });
+    check(taken && 3 == agile.size(), "pooled engine taken");
+}
+
+void test_pool_warm_up_error() {
+    wilton::support::engine_pool<agile_engine> pool;
+    std::atomic<int> calls{0};
+    bool thrown = false;
+    try {
+        pool.warm_up(8, [&calls] {
+            if (3 == calls.fetch_add(1)) {
+                throw std::runtime_error("factory failed");
+            }
+            return agile_engine(init_code());
+        }, std::vector<std::string>());
+    } catch (const wilton::support::exception&) {
+        thrown = true;
+    }
+    check(thrown, "warm-up error reported");
+    check(pool.size() < 8, "warm-up stopped on error");
+}
+
+// budget fits two engines, idle ones are evicted least recently used first,
+// busy ones are kept, evicted ones are recreated on the next call
+void test_eviction() {
+    wilton::support::script_engine_map<heap_engine> map{init_code};
+    map.set_memory_budget(250);
+    worker w1;
+    worker w2;
+    worker w3;
+    int id1 = 0;
+    int id2 = 0;
+    int id3 = 0;
+    w1.run([&] { id1 = run_id(map); });
+    next_millis();
+    w2.run([&] { id2 = run_id(map); });
+    next_millis();
+    w1.post([&] { run_id(map, "\"block\""); });
+    while (!block_entered.load()) {
+        std::this_thread::yield();
+    }
+    w3.run([&] { id3 = run_id(map); });
+    auto st = map.stats();
+    check(1 == st["evictions"].as_int64(), "idle engine evicted");
+    check(2 == st["engineCount"].as_int64(), "busy engine kept");
+    block_released.store(true);
+    w1.wait();
+
+    int id = 0;
+    next_millis();
+    w1.run([&] { id = run_id(map); });
+    check(id1 == id, "busy engine not recreated");
+    next_millis();
+    w2.run([&] { id = run_id(map); });
+    check(id2 != id, "evicted engine recreated");
+    check(2 == map.stats()["evictions"].as_int64(), "least recently used engine evicted");
+    w1.run([&] { id = run_id(map); });
+    check(id1 == id, "recently used engine kept");
+    w3.run([&] { id = run_id(map); });
+    check(id3 != id, "least recently used engine recreated");
+    check(5 == map.stats()["creations"].as_int64(), "engine creations with eviction");
+}
+
+// engines bound to their threads are not destroyed by other threads
+void test_eviction_bound() {
+    wilton::support::script_engine_map<bound_heap_engine> map{init_code};
+    map.set_memory_budget(1);
+    worker w1;
+    int id = 0;
+    w1.run([&] { id = run_id(map); });
+    run_id(map);
+    int again = 0;
+    w1.run([&] { again = run_id(map); });
+    check(id == again, "bound engine not evicted");
+    auto st = map.stats();
+    check(0 == st["evictions"].as_int64(), "no evictions of bound engines");
+    check(200 == st["heapBytes"].as_int64(), "heap of bound engines reported");
+}
+
+template<typename Fun>
+bool wait_for(Fun cond) {
+    for (int i = 0; i < 500; i++) {
+        if (cond()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+// idle engine is collected at most once incrementally and once fully per idle period,
+// incremental GC is skipped when the full one is already due
+void test_idle_gc() {
+    wilton::support::script_engine_map<gc_engine> map{init_code};
+    map.start_idle_gc(20, 60);
+    run_id(map);
+    check(wait_for([] { return 1 == gcs_full.load(); }), "full GC after idle period");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto incremental = gcs_incremental.load();
+    check(incremental <= 1, "single incremental GC per idle period");
+    check(1 == gcs_full.load(), "single full GC per idle period");
+    auto st = map.stats();
+    check(incremental == st["idleGcs"].as_int64(), "incremental GC counted");
+    check(1 == st["idleFullGcs"].as_int64(), "full GC counted");
+
+    // next idle period after the call
+    run_id(map);
+    check(wait_for([] { return 2 == gcs_full.load(); }), "full GC after next idle period");
+    check(gcs_incremental.load() <= incremental + 1, "incremental GC after next idle period");
+}
+
+// call that arrives during GC waits for it and is reported
+void test_idle_gc_wait() {
+    gcs_incremental.store(0);
+    gcs_full.store(0);
+    gc_entered.store(false);
+    gc_released.store(false);
+    wilton::support::script_engine_map<gc_engine> map{init_code};
+    map.start_idle_gc(20, 0);
+    auto first = run_id(map);
+    check(wait_for([] { return gc_entered.load(); }), "GC started");
+    std::thread releaser([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        gc_released.store(true);
+    });
+    auto second = run_id(map);
+    releaser.join();
+    check(first == second, "engine kept after GC");
+    check(1 == gcs_incremental.load(), "GC finished before the call");
+    auto st = map.stats();
+    check(1 == st["idleGcWaits"].as_int64(), "wait for GC counted");
+    check(st["idleGcWaitMicros"].as_int64() > 0, "wait for GC time reported");
+}
+
+// GC is not run on the scheduler thread for engines bound to their threads
+void test_idle_gc_bound() {
+    gcs_incremental.store(0);
+    gcs_full.store(0);
+    wilton::support::script_engine_map<bound_gc_engine> map{init_code};
+    map.start_idle_gc(10, 20);
+    run_id(map);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    check(0 == gcs_incremental.load() && 0 == gcs_full.load(), "bound engine not collected");
+    check(0 == map.stats()["idleGcs"].as_int64(), "no GC of bound engines");
+}
+
+int main() {
+    test_generation_clean();
+    test_pool_agile();
+    test_pool_warm_up_error();
+    test_eviction();
+    test_eviction_bound();
+    test_idle_gc();
+    test_idle_gc_wait();
+    test_idle_gc_bound();
+
+    return 0;
+}
@@ -25,7 +25,70 @@ void check_err(char* err) {
     }
 }
 
-const char* wilton_config() {
+void check_true(int cond, const char* msg) {
+    if (!cond) {
+        printf("check failed: %s\n", msg);
+        exit(1);
+    }
+}
+
+// error is allocated with 'wilton_alloc', from the arena if one is open
+char* fail_cb(void* ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len) {
+    (void) ctx;
+    (void) json_in;
+    (void) json_in_len;
+    (void) json_out;
+    (void) json_out_len;
+    char* err = wilton_alloc(5);
+    memcpy(err, "fail", 5);
+    return err;
+}
+
+int echo_calls = 0;
+
+// returns its input
+char* echo_cb(void* ctx, const char* json_in, int json_in_len, char** json_out, int* json_out_len) {
+    (void) ctx;
+    echo_calls += 1;
+    char* out = wilton_alloc(json_in_len);
+    memcpy(out, json_in, json_in_len);
+    *json_out = out;
+    *json_out_len = json_in_len;
+    return NULL;
+}
+
+int equal_data(const char* data, int data_len, const char* expected) {
+    return data_len == (int) strlen(expected) && 0 == memcmp(data, expected, data_len);
+}
+
+// returns null-terminated result allocated with 'malloc'
+char* call_str(const char* name, const char* json_in) {
+    char* out = NULL;
+    int out_len = 0;
+    char* err = wiltoncall(name, (int) strlen(name), json_in, (int) strlen(json_in), &out, &out_len);
+    check_err(err);
+    char* res = malloc(out_len + 1);
+    memcpy(res, out, out_len);
+    res[out_len] = '\0';
+    wilton_free(out);
+    return res;
+}
+
+int contains(const char* str, const char* sub) {
+    return NULL != strstr(str, sub);
+}
+
+void register_echo(const char* name) {
+    char* err = wiltoncall_register(name, (int) strlen(name), NULL, echo_cb);
+    check_err(err);
+}
+
+void remove_call(const char* name) {
+    char* err = wiltoncall_remove(name, (int) strlen(name));
+    check_err(err);
+}
+
+const char* test_config() {
     return "{"
     "  \"defaultScriptEngine\": \"duktape\","
     "  \"requireJs\": {"
@@ -37,6 +100,25 @@ const char* wilton_config() {
     "    \"paths\": {"
     "      \"test/scripts\": \"file://../test/scripts\" "
     "    }"
+    "  },"
+    "  \"snapshotCache\": {"
+    "    \"directory\": \".\""
+    "  },"
+    "  \"asyncPool\": {"
+    "    \"threadsCount\": 2"
+    "  },"
+    "  \"callStats\": {"
+    "    \"enabled\": true"
+    "  },"
+    "  \"trace\": {"
+    "    \"enabled\": true"
+    "  },"
+    "  \"allocator\": {"
+    "    \"tracking\": true,"
+    "    \"mmapThreshold\": 1048576"
+    "  },"
+    "  \"wiltonTest\": {"
+    "    \"items\": [10, 20]"
     "  }"
     "}";
 }
@@ -100,7 +182,7 @@ void runScript(const char* in) {
 
 void test_wiltonjs() {
     init_logging();
-    const char* config = wilton_config();
+    const char* config = test_config();
     wiltoncall_init(config, (int) strlen(config));
     runScript("{\"module\": \"test/scripts/runWiltonTests\", \"func\": \"main\"}");
 //    runScript("{\"module\": \"test/scripts/runWiltonTests\", \"func\": \"main\"}");
@@ -109,7 +191,7 @@ void test_wiltonjs() {
 }
 
 void test_dyload() {
-    const char* config = wilton_config();
+    const char* config = test_config();
     wiltoncall_init(config, (int) strlen(config));
     const char* name = "dyload_shared_library";
     const char* data = "{\"path\": \"libwilton_test_module.so\"}";
@@ -125,10 +207,447 @@ void test_dyload() {
     }
 }
 
+void test_resolve() {
+    const char* name = "wilton_test_echo";
+    register_echo(name);
+    wilton_CallHandle* handle = NULL;
+    char* err = wiltoncall_resolve(name, (int) strlen(name), &handle);
+    check_err(err);
+    for (int i = 0; i < 3; i++) {
+        char* out = NULL;
+        int out_len = 0;
+        err = wiltoncall_invoke(handle, "{\"a\":1}", 7, &out, &out_len);
+        check_err(err);
+        check_true(equal_data(out, out_len, "{\"a\":1}"), "handle call result");
+        wilton_free(out);
+    }
+    // handle stays valid, but calls through it fail after remove
+    remove_call(name);
+    char* out = NULL;
+    int out_len = 0;
+    err = wiltoncall_invoke(handle, "{}", 2, &out, &out_len);
+    check_true(NULL != err, "call through handle of removed name fails");
+    wilton_free(err);
+    err = wiltoncall_release(handle);
+    check_err(err);
+}
+
+void test_batch() {
+    const char* name = "wilton_test_echo";
+    register_echo(name);
+    const char* names[] = { name, "wilton_test_unknown", name };
+    int names_lens[] = { (int) strlen(name), 19, (int) strlen(name) };
+    const char* jsons[] = { "{\"a\":1}", "{}", "[2]" };
+    int jsons_lens[] = { 7, 2, 3 };
+    char* out = NULL;
+    int out_len = 0;
+    int offsets[4];
+    int errors[3];
+    char* err = wiltoncall_batch(names, names_lens, jsons, jsons_lens, 3, &out, &out_len, offsets, errors);
+    check_err(err);
+    check_true(0 == offsets[0] && out_len == offsets[3], "batch offsets bounds");
+    check_true(0 == errors[0] && 1 == errors[1] && 0 == errors[2], "batch item errors");
+    check_true(equal_data(out + offsets[0], offsets[1] - offsets[0], "{\"a\":1}"), "first batch item");
+    check_true(offsets[2] > offsets[1], "error message of failed batch item");
+    check_true(equal_data(out + offsets[2], offsets[3] - offsets[2], "[2]"), "last batch item");
+    wilton_free(out);
+    remove_call(name);
+}
+
+void test_async() {
+    const char* name = "wilton_test_echo";
+    register_echo(name);
+    wilton_CallFuture* future = NULL;
+    char* err = wiltoncall_async(name, (int) strlen(name), "[42]", 4, NULL, NULL, &future);
+    check_err(err);
+    int ready = 0;
+    err = wiltoncall_future_wait(future, -1, &ready);
+    check_err(err);
+    check_true(1 == ready, "async call completed");
+    char* out = NULL;
+    int out_len = 0;
+    err = wiltoncall_future_get(future, &out, &out_len);
+    check_err(err);
+    check_true(equal_data(out, out_len, "[42]"), "async call result");
+    wilton_free(out);
+    err = wiltoncall_future_destroy(future);
+    check_err(err);
+
+    // failed call, error is returned from the future
+    err = wiltoncall_async("wilton_test_unknown", 19, "{}", 2, NULL, NULL, &future);
+    if (NULL == err) {
+        err = wiltoncall_future_wait(future, -1, &ready);
+        check_err(err);
+        err = wiltoncall_future_get(future, &out, &out_len);
+        check_true(NULL != err, "async call error returned");
+        wilton_free(err);
+        err = wiltoncall_future_destroy(future);
+        check_err(err);
+    } else {
+        wilton_free(err);
+    }
+    remove_call(name);
+}
+
+void test_stats() {
+    const char* name = "wilton_test_echo";
+    register_echo(name);
+    free(call_str(name, "{}"));
+    char* res = call_str("get_wiltoncall_stats", "{}");
+    check_true(contains(res, "enabled") && contains(res, "calls") && contains(res, "caches"), "stats fields");
+    check_true(contains(res, name) && contains(res, "latencyNanos") && contains(res, "bytesIn"), "call stats fields");
+    free(res);
+    remove_call(name);
+}
+
+void test_trace() {
+    const char* name = "wilton_test_echo";
+    register_echo(name);
+    free(call_str(name, "{}"));
+    char* res = call_str("trace_dump", "{}");
+    check_true(contains(res, "traceEvents") && contains(res, name), "call traced");
+    free(res);
+    remove_call(name);
+}
+
+void test_coded() {
+    const char* name = "wilton_test_echo";
+    register_echo(name);
+    char* out = NULL;
+    int out_len = 0;
+    int code = wiltoncall_coded(name, (int) strlen(name), "[1]", 3, &out, &out_len);
+    check_true(WILTONCALL_OK == code, "coded call succeeded");
+    check_true(equal_data(out, out_len, "[1]"), "coded call result");
+    wilton_free(out);
+    code = wiltoncall_coded(NULL, 0, "{}", 2, &out, &out_len);
+    check_true(WILTONCALL_ERROR_INVALID_PARAMETER == code, "invalid parameter code");
+    code = wiltoncall_coded("wilton_test_unknown", 19, "{}", 2, &out, &out_len);
+    check_true(WILTONCALL_ERROR_UNKNOWN_NAME == code, "unknown name code");
+    check_true(WILTONCALL_ERROR_UNKNOWN_NAME == wiltoncall_last_error(NULL, 0), "last error code");
+    remove_call(name);
+}
+
+void test_cache() {
+    const char* name = "wilton_test_cached";
+    char* err = wiltoncall_register_cacheable(name, (int) strlen(name), NULL, echo_cb, 0, 16);
+    check_err(err);
+    echo_calls = 0;
+    char* res = call_str(name, "[1]");
+    check_true(0 == strcmp("[1]", res), "cached call result");
+    free(res);
+    res = call_str(name, "[1]");
+    check_true(0 == strcmp("[1]", res), "cache hit result");
+    free(res);
+    check_true(1 == echo_calls, "cache hit does not call the callback");
+    res = call_str(name, "[2]");
+    free(res);
+    check_true(2 == echo_calls, "cache miss calls the callback");
+    res = call_str("get_wiltoncall_stats", "{}");
+    check_true(contains(res, name) && contains(res, "hits"), "cache reported in stats");
+    free(res);
+    remove_call(name);
+}
+
+void test_alloc_stats() {
+    char* res = call_str("get_alloc_stats", "{}");
+    check_true(contains(res, "engine") && contains(res, "liveBytes") && contains(res, "unknownFrees"), "alloc stats fields");
+    free(res);
+}
+
+void test_shared_buffer() {
+    char* data = wilton_alloc(5);
+    memcpy(data, "hello", 5);
+    wilton_Buffer* buffer = NULL;
+    char* err = wilton_buffer_wrap(data, 5, &buffer);
+    check_err(err);
+    err = wilton_buffer_retain(buffer);
+    check_err(err);
+    // first reference released, data stays valid
+    err = wilton_buffer_release(buffer);
+    check_err(err);
+    const char* view = NULL;
+    int view_len = 0;
+    err = wilton_buffer_data(buffer, &view, &view_len);
+    check_err(err);
+    check_true(view == data && equal_data(view, view_len, "hello"), "shared buffer data");
+    err = wilton_buffer_release(buffer);
+    check_err(err);
+}
+
+// arena data is copied, buffer outlives the arena
+void test_shared_buffer_arena() {
+    wilton_Arena* arena = NULL;
+    char* err = wilton_arena_open(0, &arena);
+    check_err(err);
+    char* data = wilton_alloc(5);
+    memcpy(data, "hello", 5);
+    wilton_Buffer* buffer = NULL;
+    err = wilton_buffer_wrap(data, 5, &buffer);
+    check_err(err);
+    err = wilton_arena_close(arena);
+    check_err(err);
+    const char* view = NULL;
+    int view_len = 0;
+    err = wilton_buffer_data(buffer, &view, &view_len);
+    check_err(err);
+    check_true(view != data && equal_data(view, view_len, "hello"), "arena data copied");
+    err = wilton_buffer_release(buffer);
+    check_err(err);
+}
+
+void test_alloc_tracking() {
+    char* res = call_str("get_alloc_tracking", "{}");
+    check_true(contains(res, "origins") && contains(res, "outstanding"), "alloc tracking fields");
+    free(res);
+}
+
+// tracking is enabled in test config, foreign buffer is leaked and reported
+void test_unknown_free() {
+    char* foreign = malloc(16);
+    wilton_free(foreign);
+    char* res = call_str("get_alloc_tracking", "{}");
+    check_true(contains(res, "unknown") && contains(res, "wilton_free"), "unknown buffer reported");
+    free(res);
+    free(foreign);
+}
+
+void test_realloc() {
+    char* buf = wilton_alloc(16);
+    memcpy(buf, "0123456789abcdef", 16);
+    // grows past the mmap threshold and shrinks back
+    int sizes[] = { 64, 4096, 4 << 20, 8 };
+    size_t i;
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char* grown = wilton_realloc(buf, sizes[i]);
+        check_true(NULL != grown, "realloc succeeded");
+        buf = grown;
+        check_true(0 == memcmp(buf, "01234567", 8), "realloc keeps data");
+        memset(buf + 8, 'x', sizes[i] - 8);
+    }
+    wilton_free(buf);
+}
+
+void test_config_get() {
+    const char* paths[] = { "requireJs.waitSeconds", "snapshotCache.directory", "requireJs.missing",
+            "wiltonTest.items.1", "wiltonTest.items.5" };
+    const char* expected[] = { "0", "\".\"", "null", "20", "null" };
+    size_t i;
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        char* out = NULL;
+        int out_len = 0;
+        char* err = wilton_config_get(paths[i], (int) strlen(paths[i]), &out, &out_len);
+        check_err(err);
+        check_true(equal_data(out, out_len, expected[i]), "config value");
+        wilton_free(out);
+    }
+}
+
+void test_arena() {
+    const char* name = "get_wiltoncall_config";
+    wilton_Arena* arena = NULL;
+    char* err = wilton_arena_open(0, &arena);
+    check_err(err);
+    for (int i = 0; i < 3; i++) {
+        char* out = NULL;
+        int out_len = 0;
+        err = wiltoncall(name, (int) strlen(name), "{}", 2, &out, &out_len);
+        check_err(err);
+        wilton_free(out);
+    }
+    err = wilton_arena_close(arena);
+    check_err(err);
+}
+
+void test_arena_error() {
+    const char* name = "wilton_test_fail";
+    char* err = wiltoncall_register(name, (int) strlen(name), NULL, fail_cb);
+    check_err(err);
+    wilton_Arena* arena = NULL;
+    err = wilton_arena_open(0, &arena);
+    check_err(err);
+    char* out = NULL;
+    int out_len = 0;
+    char* call_err = wiltoncall(name, (int) strlen(name), "{}", 2, &out, &out_len);
+    check_true(NULL != call_err, "callback error returned");
+    int code = wiltoncall_coded(name, (int) strlen(name), "{}", 2, &out, &out_len);
+    check_true(WILTONCALL_ERROR_CALLBACK == code, "callback error code");
+    err = wilton_arena_close(arena);
+    check_err(err);
+    // both errors outlive the arena
+    check_true(NULL != strstr(call_err, "fail"), "callback error message");
+    wilton_free(call_err);
+    char buf[256];
+    wiltoncall_last_error(buf, (int) sizeof(buf));
+    check_true(NULL != strstr(buf, "fail"), "coded callback error message");
+    code = wiltoncall_coded("wilton_test_unknown", 19, "{}", 2, &out, &out_len);
+    check_true(WILTONCALL_ERROR_UNKNOWN_NAME == code, "unknown name code");
+    err = wiltoncall_remove(name, (int) strlen(name));
+    check_err(err);
+}
+
+void test_into() {
+    const char* name = "get_wiltoncall_config";
+    char small[4];
+    int len = 0;
+    char* err = wiltoncall_into(name, (int) strlen(name), "{}", 2, small, (int) sizeof(small), &len);
+    check_err(err);
+    check_true(len > (int) sizeof(small), "full length reported for small buffer");
+    int full_len = len;
+    char* buf = malloc(len);
+    err = wiltoncall_into(name, (int) strlen(name), "{}", 2, buf, len, &len);
+    check_err(err);
+    check_true(full_len == len, "same length with large enough buffer");
+    char* expected = call_str(name, "{}");
+    check_true(equal_data(buf, len, expected), "into result matches allocating call");
+    free(expected);
+    free(buf);
+}
+
+void test_format() {
+    const char* name = "get_wiltoncall_config";
+    char* cbor = NULL;
+    int cbor_len = 0;
+    char* err = wiltoncall_format(name, (int) strlen(name), WILTONCALL_FORMAT_JSON, "{}", 2,
+            WILTONCALL_FORMAT_CBOR, &cbor, &cbor_len);
+    check_err(err);
+    char* json = NULL;
+    int json_len = 0;
+    err = wiltoncall_transcode(WILTONCALL_FORMAT_CBOR, cbor, cbor_len, WILTONCALL_FORMAT_JSON, &json, &json_len);
+    check_err(err);
+    check_true(cbor_len > 0 && json_len > 0, "config transcoded");
+    wilton_free(json);
+    wilton_free(cbor);
+
+    // compact JSON is restored byte to byte
+    const char* in = "{\"a\":[1,-2,\"x\\u0001\",true,false,null,0.5],\"b\":{}}";
+    err = wiltoncall_transcode(WILTONCALL_FORMAT_JSON, in, (int) strlen(in), WILTONCALL_FORMAT_CBOR, &cbor, &cbor_len);
+    check_err(err);
+    err = wiltoncall_transcode(WILTONCALL_FORMAT_CBOR, cbor, cbor_len, WILTONCALL_FORMAT_JSON, &json, &json_len);
+    check_err(err);
+    check_true(equal_data(json, json_len, in), "CBOR round trip");
+    wilton_free(json);
+    wilton_free(cbor);
+}
+
+int transcode_fails(int format_in, const char* data, int data_len, int format_out) {
+    char* out = NULL;
+    int out_len = 0;
+    char* err = wiltoncall_transcode(format_in, data, data_len, format_out, &out, &out_len);
+    if (NULL == err) {
+        wilton_free(out);
+        return 0;
+    }
+    wilton_free(err);
+    return 1;
+}
+
+void test_format_invalid() {
+    const char* json[] = { "infinity", "0x10", "[nan]", "01", "1.", "\"a\x01\"", "\"\\udc00\"", "\"\xff\"", "[1,]" };
+    size_t i;
+    for (i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        check_true(transcode_fails(WILTONCALL_FORMAT_JSON, json[i], (int) strlen(json[i]), WILTONCALL_FORMAT_CBOR),
+                "malformed JSON rejected");
+    }
+    check_true(!transcode_fails(WILTONCALL_FORMAT_JSON, "[1e300,-0,0.5]", 14, WILTONCALL_FORMAT_CBOR),
+            "valid JSON numbers transcoded");
+    // text strings and map keys with invalid UTF-8
+    check_true(transcode_fails(WILTONCALL_FORMAT_CBOR, "\x62\xff\xfe", 3, WILTONCALL_FORMAT_JSON),
+            "invalid UTF-8 text rejected");
+    check_true(transcode_fails(WILTONCALL_FORMAT_CBOR, "\xa1\x61\xff\x01", 4, WILTONCALL_FORMAT_JSON),
+            "invalid UTF-8 key rejected");
+    check_true(!transcode_fails(WILTONCALL_FORMAT_CBOR, "\x62\xc3\xa9", 3, WILTONCALL_FORMAT_JSON),
+            "valid UTF-8 text transcoded");
+}
+
+void test_snapshot() {
+    const char* name = "wilton_test";
+    const char* data = "compiled";
+    char* err = wilton_snapshot_store(name, (int) strlen(name), "1.0", 3, data, (int) strlen(data));
+    check_err(err);
+    const char* loaded = NULL;
+    int loaded_len = 0;
+    err = wilton_snapshot_load(name, (int) strlen(name), "1.0", 3, &loaded, &loaded_len);
+    check_err(err);
+    if (loaded_len != (int) strlen(data) || 0 != memcmp(loaded, data, loaded_len)) {
+        puts("snapshot mismatch");
+        exit(1);
+    }
+    err = wilton_snapshot_load(name, (int) strlen(name), "2.0", 3, &loaded, &loaded_len);
+    check_err(err);
+    if (NULL != loaded) {
+        puts("stale snapshot loaded");
+        exit(1);
+    }
+    // removes the file from the working directory
+    err = wilton_snapshot_remove(name, (int) strlen(name));
+    check_err(err);
+    check_true(NULL == fopen("wilton_test.snapshot", "rb"), "snapshot file removed");
+    err = wilton_snapshot_load(name, (int) strlen(name), "1.0", 3, &loaded, &loaded_len);
+    check_err(err);
+    check_true(NULL == loaded, "removed snapshot not loaded");
+    err = wilton_snapshot_remove(name, (int) strlen(name));
+    check_err(err);
+}
+
+char* engine_stats_cb(void* ctx, char** stats_json_out, int* stats_json_len_out) {
+    (void) ctx;
+    const char* stats = "{\"engineCount\": 424242}";
+    int len = (int) strlen(stats);
+    char* json = wilton_alloc(len);
+    memcpy(json, stats, len);
+    *stats_json_out = json;
+    *stats_json_len_out = len;
+    return NULL;
+}
+
+int engine_stats_reported() {
+    const char* name = "get_engine_stats";
+    char* out = NULL;
+    int out_len = 0;
+    char* err = wiltoncall(name, (int) strlen(name), "{}", 2, &out, &out_len);
+    check_err(err);
+    printf("engine stats: %.*s\n", out_len, out);
+    int res = NULL != strstr(out, "424242");
+    wilton_free(out);
+    return res;
+}
+
+void test_engine_stats() {
+    int ctx = 0;
+    check_true(!engine_stats_reported(), "no stats before register");
+    char* err = wilton_register_engine_stats(&ctx, engine_stats_cb);
+    check_err(err);
+    check_true(engine_stats_reported(), "registered stats reported");
+    err = wilton_unregister_engine_stats(&ctx);
+    check_err(err);
+    check_true(!engine_stats_reported(), "unregistered stats not reported");
+}
+
 int main() {
 //    test_server();
 //    test_duktape_fail();
     test_wiltonjs();
+    test_resolve();
+    test_batch();
+    test_async();
+    test_stats();
+    test_trace();
+    test_coded();
+    test_cache();
+    test_alloc_stats();
+    test_shared_buffer();
+    test_shared_buffer_arena();
+    test_alloc_tracking();
+    test_unknown_free();
+    test_realloc();
+    test_config_get();
+    test_arena();
+    test_arena_error();
+    test_into();
+    test_format();
+    test_format_invalid();
+    test_snapshot();
+    test_engine_stats();
 //    test_dyload();
 
     return 0;